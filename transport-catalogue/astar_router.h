@@ -0,0 +1,138 @@
+#pragma once
+
+#include "dijkstra_router.h"
+#include "graph.h"
+#include "router_engine.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+    // Поиск A*: очередь упорядочена по сумме пройденного веса и нижней оценки остатка пути до цели.
+    // Оценка должна быть согласованной (не больше веса ребра плюс оценки из его конца),
+    // тогда найденный маршрут совпадает по весу с результатом алгоритма Дейкстры
+    template <typename Weight>
+    class AStarRouter : public RouterEngine<Weight> {
+    private:
+        using Graph = DirectedWeightedGraph<Weight>;
+
+    public:
+        using RouteInfo = graph::RouteInfo<Weight>;
+        using LowerBound = std::function<Weight(VertexId from, VertexId to)>;
+
+        AStarRouter(const Graph& graph, LowerBound lower_bound);
+
+        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+        // Для нескольких целей одно дерево кратчайших путей дешевле поиска к каждой из них
+        std::vector<std::optional<RouteInfo>> BuildRoutes(VertexId from, const std::vector<VertexId>& targets) const override;
+
+        std::optional<SearchStats> GetSearchStats() const override;
+
+    private:
+        using QueueItem = std::pair<Weight, VertexId>;
+
+        static constexpr Weight ZERO_WEIGHT{};
+        const Graph& graph_;
+        LowerBound lower_bound_;
+        mutable std::atomic<size_t> query_count_ = 0;
+        mutable std::atomic<size_t> settled_count_ = 0;
+    };
+
+    template <typename Weight>
+    AStarRouter<Weight>::AStarRouter(const Graph& graph, LowerBound lower_bound)
+            : graph_(graph)
+            , lower_bound_(std::move(lower_bound)) {
+        for (const auto& edge : graph_.GetEdges()) {
+            if (edge.weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+        }
+    }
+
+    template <typename Weight>
+    std::optional<typename AStarRouter<Weight>::RouteInfo> AStarRouter<Weight>::BuildRoute(VertexId from,
+                                                                                           VertexId to) const {
+        const size_t vertex_count = graph_.GetVertexCount();
+        if (from >= vertex_count || to >= vertex_count) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+
+        std::vector<std::optional<Weight>> weights(vertex_count);
+        std::vector<std::optional<Weight>> bounds(vertex_count);
+        std::vector<std::optional<EdgeId>> prev_edges(vertex_count);
+        std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+        auto get_bound = [&](VertexId vertex) {
+            if (!bounds[vertex]) {
+                bounds[vertex] = lower_bound_(vertex, to);
+            }
+            return *bounds[vertex];
+        };
+
+        size_t settled_count = 0;
+        weights[from] = ZERO_WEIGHT;
+        queue.push({get_bound(from), from});
+        while (!queue.empty()) {
+            const auto [estimate, vertex] = queue.top();
+            queue.pop();
+            const Weight weight = *weights[vertex];
+            if (estimate > weight + get_bound(vertex)) {
+                continue;
+            }
+            ++settled_count;
+            if (vertex == to) {
+                break;
+            }
+            for (const auto& edge : graph_.GetIncidentEdges(vertex)) {
+                const Weight candidate_weight = weight + edge.weight;
+                if (!weights[edge.to] || candidate_weight < *weights[edge.to]) {
+                    weights[edge.to] = candidate_weight;
+                    prev_edges[edge.to] = edge.id;
+                    queue.push({candidate_weight + get_bound(edge.to), edge.to});
+                }
+            }
+        }
+        ++query_count_;
+        settled_count_ += settled_count;
+
+        if (!weights[to]) {
+            return std::nullopt;
+        }
+        std::vector<EdgeId> edges;
+        for (std::optional<EdgeId> edge_id = prev_edges[to];
+             edge_id;
+             edge_id = prev_edges[graph_.GetEdge(*edge_id).from])
+        {
+            edges.push_back(*edge_id);
+        }
+        std::reverse(edges.begin(), edges.end());
+
+        return RouteInfo{*weights[to], std::move(edges)};
+    }
+
+    template <typename Weight>
+    std::vector<std::optional<typename AStarRouter<Weight>::RouteInfo>> AStarRouter<Weight>::BuildRoutes(
+            VertexId from, const std::vector<VertexId>& targets) const {
+        if (targets.size() == 1) {
+            return {BuildRoute(from, targets.front())};
+        }
+        size_t settled_count = 0;
+        auto routes = BuildShortestPathTreeRoutes(graph_, from, targets, settled_count);
+        query_count_ += targets.size();
+        settled_count_ += settled_count;
+        return routes;
+    }
+
+    template <typename Weight>
+    std::optional<SearchStats> AStarRouter<Weight>::GetSearchStats() const {
+        return SearchStats{query_count_, settled_count_};
+    }
+
+}
@@ -0,0 +1,207 @@
+#pragma once
+
+#include "dijkstra_router.h"
+#include "graph.h"
+#include "router_engine.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+    // Двунаправленный алгоритм Дейкстры: прямой поиск идёт от начала по исходящим рёбрам,
+    // обратный — от конца по входящим, поиск заканчивается, когда их фронты встречаются.
+    // Входящие рёбра один раз укладываются в CSR по вершине-концу при построении
+    template <typename Weight>
+    class BidirectionalDijkstraRouter : public RouterEngine<Weight> {
+    private:
+        using Graph = DirectedWeightedGraph<Weight>;
+
+    public:
+        using RouteInfo = graph::RouteInfo<Weight>;
+
+        explicit BidirectionalDijkstraRouter(const Graph& graph);
+
+        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+        // Для нескольких целей одно дерево кратчайших путей дешевле поиска к каждой из них
+        std::vector<std::optional<RouteInfo>> BuildRoutes(VertexId from, const std::vector<VertexId>& targets) const override;
+
+        std::optional<SearchStats> GetSearchStats() const override;
+
+    private:
+        using QueueItem = std::pair<Weight, VertexId>;
+        using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+        struct Search {
+            explicit Search(size_t vertex_count) : weights(vertex_count), edges(vertex_count) {
+            }
+
+            std::vector<std::optional<Weight>> weights;
+            // Для прямого поиска — последнее ребро пути до вершины, для обратного — первое ребро пути от неё
+            std::vector<std::optional<EdgeId>> edges;
+            Queue queue;
+        };
+
+        // Возвращает false, если из очереди извлечена устаревшая запись
+        template <typename IncidentEdges>
+        bool SettleNext(Search& search, const Search& other, IncidentEdges get_incident_edges,
+                        std::optional<Weight>& best_weight, std::optional<VertexId>& meeting_vertex) const;
+
+        typename Graph::IncidentEdgesRange GetIncomingEdges(VertexId vertex) const;
+
+        static constexpr Weight ZERO_WEIGHT{};
+        const Graph& graph_;
+        std::vector<size_t> incoming_offsets_;
+        // Поле to входящего ребра хранит его начало
+        typename Graph::IncidenceList incoming_edges_;
+        mutable std::atomic<size_t> query_count_ = 0;
+        mutable std::atomic<size_t> settled_count_ = 0;
+    };
+
+    template <typename Weight>
+    BidirectionalDijkstraRouter<Weight>::BidirectionalDijkstraRouter(const Graph& graph)
+            : graph_(graph)
+            , incoming_offsets_(graph.GetVertexCount() + 1, 0) {
+        const auto& edges = graph_.GetEdges();
+        for (const auto& edge : edges) {
+            if (edge.weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+            ++incoming_offsets_[edge.to + 1];
+        }
+        for (VertexId vertex = 0; vertex < graph_.GetVertexCount(); ++vertex) {
+            incoming_offsets_[vertex + 1] += incoming_offsets_[vertex];
+        }
+        std::vector<size_t> positions(incoming_offsets_.begin(), incoming_offsets_.end() - 1);
+        incoming_edges_.resize(edges.size());
+        for (EdgeId id = 0; id < edges.size(); ++id) {
+            const auto& edge = edges[id];
+            incoming_edges_[positions[edge.to]++] = {id, edge.from, edge.weight};
+        }
+    }
+
+    template <typename Weight>
+    typename BidirectionalDijkstraRouter<Weight>::Graph::IncidentEdgesRange
+    BidirectionalDijkstraRouter<Weight>::GetIncomingEdges(VertexId vertex) const {
+        return {incoming_edges_.begin() + incoming_offsets_[vertex],
+                incoming_edges_.begin() + incoming_offsets_[vertex + 1]};
+    }
+
+    template <typename Weight>
+    template <typename IncidentEdges>
+    bool BidirectionalDijkstraRouter<Weight>::SettleNext(Search& search, const Search& other,
+                                                         IncidentEdges get_incident_edges,
+                                                         std::optional<Weight>& best_weight,
+                                                         std::optional<VertexId>& meeting_vertex) const {
+        const auto [weight, vertex] = search.queue.top();
+        search.queue.pop();
+        if (weight > *search.weights[vertex]) {
+            return false;
+        }
+        for (const auto& edge : get_incident_edges(vertex)) {
+            const Weight candidate_weight = weight + edge.weight;
+            auto& edge_weight = search.weights[edge.to];
+            if (!edge_weight || candidate_weight < *edge_weight) {
+                edge_weight = candidate_weight;
+                search.edges[edge.to] = edge.id;
+                search.queue.push({candidate_weight, edge.to});
+                if (other.weights[edge.to]) {
+                    const Weight meeting_weight = candidate_weight + *other.weights[edge.to];
+                    if (!best_weight || meeting_weight < *best_weight) {
+                        best_weight = meeting_weight;
+                        meeting_vertex = edge.to;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    template <typename Weight>
+    std::optional<typename BidirectionalDijkstraRouter<Weight>::RouteInfo> BidirectionalDijkstraRouter<Weight>::BuildRoute(
+            VertexId from, VertexId to) const {
+        const size_t vertex_count = graph_.GetVertexCount();
+        if (from >= vertex_count || to >= vertex_count) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+        if (from == to) {
+            return RouteInfo{ZERO_WEIGHT, {}};
+        }
+
+        Search forward(vertex_count);
+        Search backward(vertex_count);
+        forward.weights[from] = ZERO_WEIGHT;
+        forward.queue.push({ZERO_WEIGHT, from});
+        backward.weights[to] = ZERO_WEIGHT;
+        backward.queue.push({ZERO_WEIGHT, to});
+
+        std::optional<Weight> best_weight;
+        std::optional<VertexId> meeting_vertex;
+        size_t settled_count = 0;
+        // Путь короче найденного должен пройти через вершины обеих очередей
+        while (!forward.queue.empty() && !backward.queue.empty()
+               && (!best_weight || forward.queue.top().first + backward.queue.top().first < *best_weight)) {
+            const bool is_settled = forward.queue.top().first <= backward.queue.top().first
+                    ? SettleNext(forward, backward, [this](VertexId vertex) { return graph_.GetIncidentEdges(vertex); },
+                                 best_weight, meeting_vertex)
+                    : SettleNext(backward, forward, [this](VertexId vertex) { return GetIncomingEdges(vertex); },
+                                 best_weight, meeting_vertex);
+            if (is_settled) {
+                ++settled_count;
+            }
+        }
+        ++query_count_;
+        settled_count_ += settled_count;
+
+        if (!meeting_vertex) {
+            return std::nullopt;
+        }
+        std::vector<EdgeId> edges;
+        for (std::optional<EdgeId> edge_id = forward.edges[*meeting_vertex];
+             edge_id;
+             edge_id = forward.edges[graph_.GetEdge(*edge_id).from])
+        {
+            edges.push_back(*edge_id);
+        }
+        std::reverse(edges.begin(), edges.end());
+        for (std::optional<EdgeId> edge_id = backward.edges[*meeting_vertex];
+             edge_id;
+             edge_id = backward.edges[graph_.GetEdge(*edge_id).to])
+        {
+            edges.push_back(*edge_id);
+        }
+
+        // Вес пересчитывается по порядку рёбер, как при однонаправленном поиске
+        Weight weight = ZERO_WEIGHT;
+        for (const EdgeId edge_id : edges) {
+            weight += graph_.GetEdge(edge_id).weight;
+        }
+        return RouteInfo{weight, std::move(edges)};
+    }
+
+    template <typename Weight>
+    std::vector<std::optional<typename BidirectionalDijkstraRouter<Weight>::RouteInfo>> BidirectionalDijkstraRouter<Weight>::BuildRoutes(
+            VertexId from, const std::vector<VertexId>& targets) const {
+        if (targets.size() == 1) {
+            return {BuildRoute(from, targets.front())};
+        }
+        size_t settled_count = 0;
+        auto routes = BuildShortestPathTreeRoutes(graph_, from, targets, settled_count);
+        query_count_ += targets.size();
+        settled_count_ += settled_count;
+        return routes;
+    }
+
+    template <typename Weight>
+    std::optional<SearchStats> BidirectionalDijkstraRouter<Weight>::GetSearchStats() const {
+        return SearchStats{query_count_, settled_count_};
+    }
+
+}
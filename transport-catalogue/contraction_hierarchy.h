@@ -0,0 +1,466 @@
+#pragma once
+
+#include "graph.h"
+#include "router_engine.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <tuple>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+    // Contraction Hierarchies: вершины стягиваются по возрастанию важности (rank),
+    // при этом добавляются рёбра-сокращения, сохраняющие кратчайшие расстояния.
+    // Запрос выполняется двунаправленным поиском только вверх по иерархии
+    template <typename Weight>
+    class ContractionHierarchy : public RouterEngine<Weight> {
+    private:
+        using Graph = DirectedWeightedGraph<Weight>;
+
+    public:
+        using RouteInfo = graph::RouteInfo<Weight>;
+
+        // Сокращение from -> to заменяет пару рёбер first, second. Идентификаторы рёбер
+        // меньше GetEdgeCount() графа ссылаются на исходные рёбра, остальные — на сокращения
+        struct Shortcut {
+            VertexId from;
+            VertexId to;
+            Weight weight;
+            EdgeId first;
+            EdgeId second;
+        };
+
+        explicit ContractionHierarchy(const Graph& graph);
+
+        ContractionHierarchy(const Graph& graph, std::vector<size_t>&& ranks, std::vector<Shortcut>&& shortcuts);
+
+        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+        const std::vector<size_t>& GetRanks() const;
+
+        const std::vector<Shortcut>& GetShortcuts() const;
+
+    private:
+        struct UpwardEdge {
+            EdgeId id;
+            VertexId vertex;
+            Weight weight;
+        };
+
+        struct UpwardGraph {
+            std::vector<size_t> offsets;
+            std::vector<UpwardEdge> edges;
+        };
+
+        class Contractor;
+
+        using QueueItem = std::pair<Weight, VertexId>;
+        using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+        struct Search {
+            std::vector<std::optional<Weight>> weights;
+            std::vector<std::optional<EdgeId>> prev_edges;
+            Queue queue;
+        };
+
+        void BuildUpwardGraphs();
+
+        void SettleNext(Search& search, const Search& other, const UpwardGraph& upward_graph,
+                        std::optional<Weight>& best_weight, std::optional<VertexId>& meeting_vertex) const;
+
+        VertexId GetEdgeFrom(EdgeId id) const;
+
+        VertexId GetEdgeTo(EdgeId id) const;
+
+        void UnpackEdge(EdgeId id, std::vector<EdgeId>& edges) const;
+
+        static constexpr Weight ZERO_WEIGHT{};
+        const Graph& graph_;
+        std::vector<size_t> ranks_;
+        std::vector<Shortcut> shortcuts_;
+        UpwardGraph forward_graph_;
+        UpwardGraph backward_graph_;
+    };
+
+    template <typename Weight>
+    class ContractionHierarchy<Weight>::Contractor {
+    public:
+        explicit Contractor(const Graph& graph)
+                : graph_(graph)
+                , out_edges_(graph.GetVertexCount())
+                , in_edges_(graph.GetVertexCount())
+                , contracted_neighbors_(graph.GetVertexCount(), 0)
+                , witness_weights_(graph.GetVertexCount(), NO_WEIGHT)
+                , is_witness_target_(graph.GetVertexCount(), false) {
+            const auto& edges = graph.GetEdges();
+            for (EdgeId id = 0; id < edges.size(); ++id) {
+                const auto& edge = edges[id];
+                if (edge.weight < ZERO_WEIGHT) {
+                    throw std::domain_error("Edges' weights should be non-negative");
+                }
+                if (edge.from != edge.to) {
+                    out_edges_[edge.from].push_back({id, edge.to, edge.weight});
+                }
+            }
+            // Параллельные рёбра разных автобусов не влияют на расстояния: при стягивании
+            // достаточно самого лёгкого из них
+            for (VertexId vertex = 0; vertex < graph.GetVertexCount(); ++vertex) {
+                out_edges_[vertex] = GetLightestEdges(out_edges_[vertex]);
+                for (const auto& edge : out_edges_[vertex]) {
+                    in_edges_[edge.vertex].push_back({edge.id, vertex, edge.weight});
+                }
+                std::sort(out_edges_[vertex].begin(), out_edges_[vertex].end(), IsLighter);
+            }
+        }
+
+        void Run(std::vector<size_t>& ranks, std::vector<Shortcut>& shortcuts) {
+            const size_t vertex_count = graph_.GetVertexCount();
+            using PriorityItem = std::pair<int64_t, VertexId>;
+            std::priority_queue<PriorityItem, std::vector<PriorityItem>, std::greater<PriorityItem>> queue;
+            for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+                queue.push({GetPriority(vertex), vertex});
+            }
+
+            ranks.assign(vertex_count, 0);
+            size_t next_rank = 0;
+            while (!queue.empty()) {
+                const VertexId vertex = queue.top().second;
+                queue.pop();
+                // Ленивое обновление: приоритет пересчитывается перед стягиванием
+                const int64_t priority = GetPriority(vertex);
+                if (!queue.empty() && priority > queue.top().first) {
+                    queue.push({priority, vertex});
+                    continue;
+                }
+                Contract(vertex, shortcuts);
+                ranks[vertex] = next_rank++;
+            }
+        }
+
+    private:
+        static constexpr Weight NO_WEIGHT = std::numeric_limits<Weight>::max();
+        static constexpr size_t WITNESS_SETTLED_LIMIT = 50;
+
+        int64_t GetPriority(VertexId vertex) {
+            std::vector<Shortcut> shortcuts;
+            FindShortcuts(vertex, shortcuts);
+            return static_cast<int64_t>(shortcuts.size())
+                   - static_cast<int64_t>(out_edges_[vertex].size() + in_edges_[vertex].size())
+                   + contracted_neighbors_[vertex];
+        }
+
+        static bool IsLighter(const UpwardEdge& lhs, const UpwardEdge& rhs) {
+            return lhs.weight < rhs.weight;
+        }
+
+        static std::vector<UpwardEdge> GetLightestEdges(const std::vector<UpwardEdge>& edges) {
+            std::vector<UpwardEdge> result(edges);
+            std::sort(result.begin(), result.end(), [](const UpwardEdge& lhs, const UpwardEdge& rhs) {
+                return std::tuple{lhs.vertex, lhs.weight, lhs.id} < std::tuple{rhs.vertex, rhs.weight, rhs.id};
+            });
+            result.erase(std::unique(result.begin(), result.end(), [](const UpwardEdge& lhs, const UpwardEdge& rhs) {
+                return lhs.vertex == rhs.vertex;
+            }), result.end());
+            return result;
+        }
+
+        void FindShortcuts(VertexId vertex, std::vector<Shortcut>& shortcuts) {
+            const std::vector<UpwardEdge> in_edges = GetLightestEdges(in_edges_[vertex]);
+            const std::vector<UpwardEdge> out_edges = GetLightestEdges(out_edges_[vertex]);
+            for (const auto& in_edge : in_edges) {
+                Weight max_weight = ZERO_WEIGHT;
+                size_t target_count = 0;
+                for (const auto& out_edge : out_edges) {
+                    if (out_edge.vertex != in_edge.vertex) {
+                        max_weight = std::max(max_weight, in_edge.weight + out_edge.weight);
+                        is_witness_target_[out_edge.vertex] = true;
+                        ++target_count;
+                    }
+                }
+                RunWitnessSearch(in_edge.vertex, vertex, max_weight, target_count);
+                for (const auto& out_edge : out_edges) {
+                    if (out_edge.vertex == in_edge.vertex) {
+                        continue;
+                    }
+                    const Weight weight = in_edge.weight + out_edge.weight;
+                    if (witness_weights_[out_edge.vertex] > weight) {
+                        shortcuts.push_back({in_edge.vertex, out_edge.vertex, weight, in_edge.id, out_edge.id});
+                    }
+                    is_witness_target_[out_edge.vertex] = false;
+                }
+                ResetWitnessSearch();
+            }
+        }
+
+        // Ограниченный поиск пути source -> * в оставшемся графе в обход стягиваемой вершины.
+        // Останавливается, когда найдены расстояния до всех target_count соседей
+        void RunWitnessSearch(VertexId source, VertexId ignored, Weight max_weight, size_t target_count) {
+            Queue queue;
+            witness_weights_[source] = ZERO_WEIGHT;
+            touched_.push_back(source);
+            queue.push({ZERO_WEIGHT, source});
+            size_t settled = 0;
+            while (!queue.empty() && settled < WITNESS_SETTLED_LIMIT) {
+                const auto [weight, vertex] = queue.top();
+                queue.pop();
+                if (weight > witness_weights_[vertex]) {
+                    continue;
+                }
+                if (weight > max_weight) {
+                    break;
+                }
+                ++settled;
+                if (is_witness_target_[vertex] && --target_count == 0) {
+                    break;
+                }
+                for (const auto& edge : out_edges_[vertex]) {
+                    const Weight candidate_weight = weight + edge.weight;
+                    // Исходящие рёбра упорядочены по весу, дальше только более длинные пути
+                    if (candidate_weight > max_weight) {
+                        break;
+                    }
+                    if (edge.vertex == ignored) {
+                        continue;
+                    }
+                    if (candidate_weight < witness_weights_[edge.vertex]) {
+                        if (witness_weights_[edge.vertex] == NO_WEIGHT) {
+                            touched_.push_back(edge.vertex);
+                        }
+                        witness_weights_[edge.vertex] = candidate_weight;
+                        queue.push({candidate_weight, edge.vertex});
+                    }
+                }
+            }
+        }
+
+        void ResetWitnessSearch() {
+            for (const VertexId vertex : touched_) {
+                witness_weights_[vertex] = NO_WEIGHT;
+            }
+            touched_.clear();
+        }
+
+        void Contract(VertexId vertex, std::vector<Shortcut>& shortcuts) {
+            std::vector<Shortcut> new_shortcuts;
+            FindShortcuts(vertex, new_shortcuts);
+            for (auto& shortcut : new_shortcuts) {
+                const EdgeId id = graph_.GetEdgeCount() + shortcuts.size();
+                auto& out_edges = out_edges_[shortcut.from];
+                const UpwardEdge edge{id, shortcut.to, shortcut.weight};
+                out_edges.insert(std::upper_bound(out_edges.begin(), out_edges.end(), edge, IsLighter), edge);
+                in_edges_[shortcut.to].push_back({id, shortcut.from, shortcut.weight});
+                shortcuts.push_back(shortcut);
+            }
+
+            auto is_contracted = [&](const UpwardEdge& edge) {
+                return edge.vertex == vertex;
+            };
+            for (const auto& edge : in_edges_[vertex]) {
+                auto& edges = out_edges_[edge.vertex];
+                edges.erase(std::remove_if(edges.begin(), edges.end(), is_contracted), edges.end());
+                ++contracted_neighbors_[edge.vertex];
+            }
+            for (const auto& edge : out_edges_[vertex]) {
+                auto& edges = in_edges_[edge.vertex];
+                edges.erase(std::remove_if(edges.begin(), edges.end(), is_contracted), edges.end());
+                ++contracted_neighbors_[edge.vertex];
+            }
+            out_edges_[vertex].clear();
+            in_edges_[vertex].clear();
+        }
+
+        const Graph& graph_;
+        std::vector<std::vector<UpwardEdge>> out_edges_;
+        std::vector<std::vector<UpwardEdge>> in_edges_;
+        std::vector<int64_t> contracted_neighbors_;
+        std::vector<Weight> witness_weights_;
+        std::vector<bool> is_witness_target_;
+        std::vector<VertexId> touched_;
+    };
+
+    template <typename Weight>
+    ContractionHierarchy<Weight>::ContractionHierarchy(const Graph& graph) : graph_(graph) {
+        Contractor(graph).Run(ranks_, shortcuts_);
+        BuildUpwardGraphs();
+    }
+
+    template <typename Weight>
+    ContractionHierarchy<Weight>::ContractionHierarchy(const Graph& graph, std::vector<size_t>&& ranks,
+                                                       std::vector<Shortcut>&& shortcuts)
+            : graph_(graph)
+            , ranks_(std::move(ranks))
+            , shortcuts_(std::move(shortcuts)) {
+        if (ranks_.size() != graph_.GetVertexCount()) {
+            throw std::invalid_argument("Ranks don't match vertex count");
+        }
+        BuildUpwardGraphs();
+    }
+
+    // Ребро попадает в прямой граф, если ведёт к более важной вершине, иначе — в обратный
+    template <typename Weight>
+    void ContractionHierarchy<Weight>::BuildUpwardGraphs() {
+        const size_t vertex_count = graph_.GetVertexCount();
+        const size_t edge_count = graph_.GetEdgeCount() + shortcuts_.size();
+        forward_graph_.offsets.assign(vertex_count + 1, 0);
+        backward_graph_.offsets.assign(vertex_count + 1, 0);
+
+        auto for_each_edge = [&](auto&& action) {
+            for (EdgeId id = 0; id < edge_count; ++id) {
+                const VertexId from = GetEdgeFrom(id);
+                const VertexId to = GetEdgeTo(id);
+                if (from == to) {
+                    continue;
+                }
+                const Weight weight = id < graph_.GetEdgeCount() ? graph_.GetEdge(id).weight
+                                                                 : shortcuts_[id - graph_.GetEdgeCount()].weight;
+                if (ranks_.at(from) < ranks_.at(to)) {
+                    action(forward_graph_, from, UpwardEdge{id, to, weight});
+                } else {
+                    action(backward_graph_, to, UpwardEdge{id, from, weight});
+                }
+            }
+        };
+
+        for_each_edge([](UpwardGraph& upward_graph, VertexId vertex, const UpwardEdge&) {
+            ++upward_graph.offsets[vertex + 1];
+        });
+        for (UpwardGraph* upward_graph : {&forward_graph_, &backward_graph_}) {
+            for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+                upward_graph->offsets[vertex + 1] += upward_graph->offsets[vertex];
+            }
+            upward_graph->edges.resize(upward_graph->offsets.back());
+        }
+        std::vector<size_t> forward_positions(forward_graph_.offsets.begin(), forward_graph_.offsets.end() - 1);
+        std::vector<size_t> backward_positions(backward_graph_.offsets.begin(), backward_graph_.offsets.end() - 1);
+        for_each_edge([&](UpwardGraph& upward_graph, VertexId vertex, const UpwardEdge& edge) {
+            auto& positions = &upward_graph == &forward_graph_ ? forward_positions : backward_positions;
+            upward_graph.edges[positions[vertex]++] = edge;
+        });
+    }
+
+    template <typename Weight>
+    void ContractionHierarchy<Weight>::SettleNext(Search& search, const Search& other, const UpwardGraph& upward_graph,
+                                                  std::optional<Weight>& best_weight,
+                                                  std::optional<VertexId>& meeting_vertex) const {
+        const auto [weight, vertex] = search.queue.top();
+        search.queue.pop();
+        if (weight > *search.weights[vertex]) {
+            return;
+        }
+        if (best_weight && weight >= *best_weight) {
+            search.queue = {};
+            return;
+        }
+        if (other.weights[vertex]) {
+            const Weight candidate_weight = weight + *other.weights[vertex];
+            if (!best_weight || candidate_weight < *best_weight) {
+                best_weight = candidate_weight;
+                meeting_vertex = vertex;
+            }
+        }
+        for (size_t i = upward_graph.offsets[vertex]; i < upward_graph.offsets[vertex + 1]; ++i) {
+            const auto& edge = upward_graph.edges[i];
+            const Weight candidate_weight = weight + edge.weight;
+            auto& edge_weight = search.weights[edge.vertex];
+            if (!edge_weight || candidate_weight < *edge_weight) {
+                edge_weight = candidate_weight;
+                search.prev_edges[edge.vertex] = edge.id;
+                search.queue.push({candidate_weight, edge.vertex});
+            }
+        }
+    }
+
+    template <typename Weight>
+    std::optional<typename ContractionHierarchy<Weight>::RouteInfo> ContractionHierarchy<Weight>::BuildRoute(
+            VertexId from, VertexId to) const {
+        const size_t vertex_count = graph_.GetVertexCount();
+        if (from >= vertex_count || to >= vertex_count) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+
+        Search forward{std::vector<std::optional<Weight>>(vertex_count), std::vector<std::optional<EdgeId>>(vertex_count), {}};
+        Search backward{std::vector<std::optional<Weight>>(vertex_count), std::vector<std::optional<EdgeId>>(vertex_count), {}};
+        forward.weights[from] = ZERO_WEIGHT;
+        forward.queue.push({ZERO_WEIGHT, from});
+        backward.weights[to] = ZERO_WEIGHT;
+        backward.queue.push({ZERO_WEIGHT, to});
+
+        std::optional<Weight> best_weight;
+        std::optional<VertexId> meeting_vertex;
+        while (!forward.queue.empty() || !backward.queue.empty()) {
+            const bool is_forward_turn = backward.queue.empty()
+                                         || (!forward.queue.empty() && forward.queue.top() < backward.queue.top());
+            if (is_forward_turn) {
+                SettleNext(forward, backward, forward_graph_, best_weight, meeting_vertex);
+            } else {
+                SettleNext(backward, forward, backward_graph_, best_weight, meeting_vertex);
+            }
+        }
+        if (!meeting_vertex) {
+            return std::nullopt;
+        }
+
+        std::vector<EdgeId> upward_edges;
+        for (VertexId vertex = *meeting_vertex; forward.prev_edges[vertex]; vertex = GetEdgeFrom(*forward.prev_edges[vertex])) {
+            upward_edges.push_back(*forward.prev_edges[vertex]);
+        }
+        std::reverse(upward_edges.begin(), upward_edges.end());
+        for (VertexId vertex = *meeting_vertex; backward.prev_edges[vertex]; vertex = GetEdgeTo(*backward.prev_edges[vertex])) {
+            upward_edges.push_back(*backward.prev_edges[vertex]);
+        }
+
+        std::vector<EdgeId> edges;
+        Weight weight = ZERO_WEIGHT;
+        for (const EdgeId id : upward_edges) {
+            UnpackEdge(id, edges);
+        }
+        for (const EdgeId id : edges) {
+            weight += graph_.GetEdge(id).weight;
+        }
+        return RouteInfo{weight, std::move(edges)};
+    }
+
+    template <typename Weight>
+    VertexId ContractionHierarchy<Weight>::GetEdgeFrom(EdgeId id) const {
+        return id < graph_.GetEdgeCount() ? graph_.GetEdge(id).from : shortcuts_.at(id - graph_.GetEdgeCount()).from;
+    }
+
+    template <typename Weight>
+    VertexId ContractionHierarchy<Weight>::GetEdgeTo(EdgeId id) const {
+        return id < graph_.GetEdgeCount() ? graph_.GetEdge(id).to : shortcuts_.at(id - graph_.GetEdgeCount()).to;
+    }
+
+    template <typename Weight>
+    void ContractionHierarchy<Weight>::UnpackEdge(EdgeId id, std::vector<EdgeId>& edges) const {
+        std::vector<EdgeId> stack{id};
+        while (!stack.empty()) {
+            const EdgeId current = stack.back();
+            stack.pop_back();
+            if (current < graph_.GetEdgeCount()) {
+                edges.push_back(current);
+            } else {
+                const Shortcut& shortcut = shortcuts_.at(current - graph_.GetEdgeCount());
+                stack.push_back(shortcut.second);
+                stack.push_back(shortcut.first);
+            }
+        }
+    }
+
+    template <typename Weight>
+    const std::vector<size_t>& ContractionHierarchy<Weight>::GetRanks() const {
+        return ranks_;
+    }
+
+    template <typename Weight>
+    const std::vector<typename ContractionHierarchy<Weight>::Shortcut>& ContractionHierarchy<Weight>::GetShortcuts() const {
+        return shortcuts_;
+    }
+
+}
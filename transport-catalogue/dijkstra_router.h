@@ -0,0 +1,197 @@
+#pragma once
+
+#include "graph.h"
+#include "router_engine.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+    // Дерево кратчайших путей из from растёт, пока не будут окончательно обработаны все targets;
+    // маршруты до них возвращаются в порядке targets. Вес ребра берётся из get_weight(incident_edge),
+    // что позволяет искать по весам, вычисляемым во время запроса
+    template <typename Weight, typename EdgeWeight>
+    std::vector<std::optional<RouteInfo<Weight>>> BuildShortestPathTreeRoutes(const DirectedWeightedGraph<Weight>& graph,
+                                                                             VertexId from,
+                                                                             const std::vector<VertexId>& targets,
+                                                                             size_t& settled_count,
+                                                                             EdgeWeight get_weight) {
+        using QueueItem = std::pair<Weight, VertexId>;
+        static constexpr Weight ZERO_WEIGHT{};
+
+        const size_t vertex_count = graph.GetVertexCount();
+        if (from >= vertex_count) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+        std::vector<bool> is_target(vertex_count, false);
+        size_t target_count = 0;
+        for (const VertexId to : targets) {
+            if (to >= vertex_count) {
+                throw std::out_of_range("Vertex id is out of range");
+            }
+            if (!is_target[to]) {
+                is_target[to] = true;
+                ++target_count;
+            }
+        }
+
+        std::vector<std::optional<Weight>> weights(vertex_count);
+        std::vector<std::optional<EdgeId>> prev_edges(vertex_count);
+        std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+
+        weights[from] = ZERO_WEIGHT;
+        queue.push({ZERO_WEIGHT, from});
+        while (!queue.empty() && target_count > 0) {
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+            if (weight > *weights[vertex]) {
+                continue;
+            }
+            ++settled_count;
+            if (is_target[vertex]) {
+                is_target[vertex] = false;
+                if (--target_count == 0) {
+                    break;
+                }
+            }
+            for (const auto& edge : graph.GetIncidentEdges(vertex)) {
+                const Weight candidate_weight = weight + get_weight(edge);
+                if (!weights[edge.to] || candidate_weight < *weights[edge.to]) {
+                    weights[edge.to] = candidate_weight;
+                    prev_edges[edge.to] = edge.id;
+                    queue.push({candidate_weight, edge.to});
+                }
+            }
+        }
+
+        std::vector<std::optional<RouteInfo<Weight>>> routes;
+        routes.reserve(targets.size());
+        for (const VertexId to : targets) {
+            if (!weights[to]) {
+                routes.emplace_back(std::nullopt);
+                continue;
+            }
+            std::vector<EdgeId> edges;
+            for (std::optional<EdgeId> edge_id = prev_edges[to];
+                 edge_id;
+                 edge_id = prev_edges[graph.GetEdge(*edge_id).from])
+            {
+                edges.push_back(*edge_id);
+            }
+            std::reverse(edges.begin(), edges.end());
+            routes.push_back(RouteInfo<Weight>{*weights[to], std::move(edges)});
+        }
+        return routes;
+    }
+
+    template <typename Weight>
+    std::vector<std::optional<RouteInfo<Weight>>> BuildShortestPathTreeRoutes(const DirectedWeightedGraph<Weight>& graph,
+                                                                             VertexId from,
+                                                                             const std::vector<VertexId>& targets,
+                                                                             size_t& settled_count) {
+        return BuildShortestPathTreeRoutes(graph, from, targets, settled_count, [](const IncidentEdge<Weight>& edge) {
+            return edge.weight;
+        });
+    }
+
+    // Вершины, достижимые из from с весом не больше max_weight, в порядке возрастания веса.
+    // Поиск заканчивается на первой извлечённой из очереди вершине за этой границей
+    template <typename Weight>
+    std::vector<std::pair<VertexId, Weight>> BuildBoundedShortestPathWeights(const DirectedWeightedGraph<Weight>& graph,
+                                                                            VertexId from, Weight max_weight) {
+        using QueueItem = std::pair<Weight, VertexId>;
+        static constexpr Weight ZERO_WEIGHT{};
+
+        if (from >= graph.GetVertexCount()) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+        std::vector<std::pair<VertexId, Weight>> result;
+        std::vector<std::optional<Weight>> weights(graph.GetVertexCount());
+        std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+
+        weights[from] = ZERO_WEIGHT;
+        queue.push({ZERO_WEIGHT, from});
+        while (!queue.empty()) {
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+            if (max_weight < weight) {
+                break;
+            }
+            if (weight > *weights[vertex]) {
+                continue;
+            }
+            result.emplace_back(vertex, weight);
+            for (const auto& edge : graph.GetIncidentEdges(vertex)) {
+                const Weight candidate_weight = weight + edge.weight;
+                if (!weights[edge.to] || candidate_weight < *weights[edge.to]) {
+                    weights[edge.to] = candidate_weight;
+                    queue.push({candidate_weight, edge.to});
+                }
+            }
+        }
+        return result;
+    }
+
+    // Маршрут ищется при каждом запросе алгоритмом Дейкстры с бинарной кучей,
+    // поэтому построение не требует предрасчёта таблицы всех пар вершин
+    template <typename Weight>
+    class DijkstraRouter : public RouterEngine<Weight> {
+    private:
+        using Graph = DirectedWeightedGraph<Weight>;
+
+    public:
+        using RouteInfo = graph::RouteInfo<Weight>;
+
+        explicit DijkstraRouter(const Graph& graph);
+
+        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+        std::vector<std::optional<RouteInfo>> BuildRoutes(VertexId from, const std::vector<VertexId>& targets) const override;
+
+        std::optional<SearchStats> GetSearchStats() const override;
+
+    private:
+        static constexpr Weight ZERO_WEIGHT{};
+        const Graph& graph_;
+        mutable std::atomic<size_t> query_count_ = 0;
+        mutable std::atomic<size_t> settled_count_ = 0;
+    };
+
+    template <typename Weight>
+    DijkstraRouter<Weight>::DijkstraRouter(const Graph& graph) : graph_(graph) {
+        for (const auto& edge : graph_.GetEdges()) {
+            if (edge.weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+        }
+    }
+
+    template <typename Weight>
+    std::optional<typename DijkstraRouter<Weight>::RouteInfo> DijkstraRouter<Weight>::BuildRoute(VertexId from,
+                                                                                                 VertexId to) const {
+        return std::move(BuildRoutes(from, {to}).front());
+    }
+
+    template <typename Weight>
+    std::vector<std::optional<typename DijkstraRouter<Weight>::RouteInfo>> DijkstraRouter<Weight>::BuildRoutes(
+            VertexId from, const std::vector<VertexId>& targets) const {
+        size_t settled_count = 0;
+        auto routes = BuildShortestPathTreeRoutes(graph_, from, targets, settled_count);
+        query_count_ += targets.size();
+        settled_count_ += settled_count;
+        return routes;
+    }
+
+    template <typename Weight>
+    std::optional<SearchStats> DijkstraRouter<Weight>::GetSearchStats() const {
+        return SearchStats{query_count_, settled_count_};
+    }
+
+}
@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <string>
 #include <variant>
 #include "graph.h"
@@ -10,6 +11,7 @@ struct RouteRequest {
     int id;
 };
 
+// В модели графа SINGLE_VERTEX у остановки одна вершина: bus_wait_begin и bus_wait_end совпадают
 struct StopPairVertexId {
     graph::VertexId bus_wait_begin;
     graph::VertexId bus_wait_end;
@@ -28,11 +30,30 @@ struct BusEdgeInfo {
 
 using EdgeInfo = std::variant<WaitEdgeInfo, BusEdgeInfo>;
 
+// Перегон между соседними остановками автобуса в модели линейного графа
+struct RideEdgeInfo {
+    std::string_view bus_name;
+    uint64_t distance = 0;
+};
+
+// Из чего складывается вес ребра графа: wait_count ожиданий автобуса и проезд distance метров.
+// Вес по этим величинам можно пересчитать для любых настроек маршрутизации
+struct RawEdgeWeight {
+    uint64_t distance = 0;
+    uint32_t wait_count = 0;
+};
+
 struct RouteInfo {
     double total_time = 0;
     std::vector<std::variant<WaitEdgeInfo, BusEdgeInfo>> edges;
 };
 
+// Остановка, достижимая за отведённое время, и время прибытия на неё
+struct ReachableStop {
+    std::string_view stop_name;
+    double time = 0;
+};
+
 struct SerializationSettings {
     std::string name_file;
 };
@@ -3,6 +3,8 @@
 #include "ranges.h"
 
 #include <cstdlib>
+#include <optional>
+#include <stdexcept>
 #include <vector>
 
 namespace graph {
@@ -17,18 +19,43 @@ namespace graph {
         Weight weight;
     };
 
+    // Изменение графа для инкрементального обновления движков: у вставленного ребра нет старого веса
+    template <typename Weight>
+    struct EdgeUpdate {
+        EdgeId id;
+        std::optional<Weight> old_weight;
+    };
+
+    // Исходящее ребро в сжатом (CSR) представлении: вершина-источник задаётся смещением
+    template <typename Weight>
+    struct IncidentEdge {
+        EdgeId id;
+        VertexId to;
+        Weight weight;
+    };
+
+    // Граф наполняется через AddEdge, после чего замораживается методом Freeze:
+    // исходящие рёбра всех вершин укладываются в один массив, упорядоченный по вершине-источнику
     template <typename Weight>
     class DirectedWeightedGraph {
     public:
-        using IncidenceList = std::vector<EdgeId>;
+        using IncidenceList = std::vector<IncidentEdge<Weight>>;
         using IncidentEdgesRange = ranges::Range<typename IncidenceList::const_iterator>;
         DirectedWeightedGraph() = default;
 
-        DirectedWeightedGraph(std::vector<graph::Edge<double>>&& edges, std::vector<IncidenceList>&& incidence_lists);
+        DirectedWeightedGraph(std::vector<size_t>&& incidence_offsets, IncidenceList&& incident_edges);
 
         explicit DirectedWeightedGraph(size_t vertex_count);
         EdgeId AddEdge(const Edge<Weight>& edge);
 
+        // Возвращает номер первой из добавленных вершин
+        VertexId AddVertices(size_t count);
+
+        void SetEdgeWeight(EdgeId edge_id, Weight weight);
+
+        void Freeze();
+        bool IsFrozen() const;
+
         size_t GetVertexCount() const;
         size_t GetEdgeCount() const;
         const Edge<Weight>& GetEdge(EdgeId edge_id) const;
@@ -36,34 +63,103 @@ namespace graph {
 
         const std::vector<Edge<Weight>>& GetEdges() const;
 
-        const std::vector<IncidenceList>& GetIncidenceList() const;
+        const std::vector<size_t>& GetIncidenceOffsets() const;
+        const IncidenceList& GetAllIncidentEdges() const;
 
     private:
+        size_t vertex_count_ = 0;
+        bool frozen_ = false;
         std::vector<Edge<Weight>> edges_;
-        std::vector<IncidenceList> incidence_lists_;
+        std::vector<size_t> incidence_offsets_;
+        IncidenceList incident_edges_;
     };
 
     template <typename Weight>
     DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count)
-            : incidence_lists_(vertex_count) {
+            : vertex_count_(vertex_count) {
+    }
+
+    template <typename Weight>
+    DirectedWeightedGraph<Weight>::DirectedWeightedGraph(std::vector<size_t>&& incidence_offsets,
+                                                         IncidenceList&& incident_edges)
+            : vertex_count_(incidence_offsets.empty() ? 0 : incidence_offsets.size() - 1)
+            , frozen_(true)
+            , edges_(incident_edges.size())
+            , incidence_offsets_(std::move(incidence_offsets))
+            , incident_edges_(std::move(incident_edges)) {
+        if (incidence_offsets_.empty() || incidence_offsets_.back() != incident_edges_.size()) {
+            throw std::invalid_argument("Incidence offsets don't match incident edges");
+        }
+        for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+            for (size_t i = incidence_offsets_[vertex]; i < incidence_offsets_[vertex + 1]; ++i) {
+                const auto& incident_edge = incident_edges_[i];
+                edges_.at(incident_edge.id) = {vertex, incident_edge.to, incident_edge.weight};
+            }
+        }
     }
 
     template <typename Weight>
     EdgeId DirectedWeightedGraph<Weight>::AddEdge(const Edge<Weight>& edge) {
+        if (edge.from >= vertex_count_ || edge.to >= vertex_count_) {
+            throw std::out_of_range("Edge vertex is out of range");
+        }
         edges_.push_back(edge);
-        const EdgeId id = edges_.size() - 1;
-        incidence_lists_.at(edge.from).push_back(id);
-        return id;
+        frozen_ = false;
+        return edges_.size() - 1;
     }
 
     template <typename Weight>
-    size_t DirectedWeightedGraph<Weight>::GetVertexCount() const {
-        return incidence_lists_.size();
+    VertexId DirectedWeightedGraph<Weight>::AddVertices(size_t count) {
+        const VertexId first_vertex = vertex_count_;
+        vertex_count_ += count;
+        frozen_ = false;
+        return first_vertex;
     }
 
+    // Вес меняется и в замороженном графе: исходящее ребро ищется среди рёбер его начала
     template <typename Weight>
-    DirectedWeightedGraph<Weight>::DirectedWeightedGraph(std::vector<graph::Edge<double>>&& edges,
-                                                         std::vector<IncidenceList>&& incidence_lists) : edges_(std::move(edges)), incidence_lists_(std::move(incidence_lists)) {}
+    void DirectedWeightedGraph<Weight>::SetEdgeWeight(EdgeId edge_id, Weight weight) {
+        Edge<Weight>& edge = edges_.at(edge_id);
+        edge.weight = weight;
+        if (!frozen_) {
+            return;
+        }
+        for (size_t i = incidence_offsets_[edge.from]; i < incidence_offsets_[edge.from + 1]; ++i) {
+            if (incident_edges_[i].id == edge_id) {
+                incident_edges_[i].weight = weight;
+                return;
+            }
+        }
+    }
+
+    template <typename Weight>
+    void DirectedWeightedGraph<Weight>::Freeze() {
+        incidence_offsets_.assign(vertex_count_ + 1, 0);
+        for (const auto& edge : edges_) {
+            ++incidence_offsets_[edge.from + 1];
+        }
+        for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+            incidence_offsets_[vertex + 1] += incidence_offsets_[vertex];
+        }
+
+        std::vector<size_t> positions(incidence_offsets_.begin(), incidence_offsets_.end() - 1);
+        incident_edges_.resize(edges_.size());
+        for (EdgeId id = 0; id < edges_.size(); ++id) {
+            const auto& edge = edges_[id];
+            incident_edges_[positions[edge.from]++] = {id, edge.to, edge.weight};
+        }
+        frozen_ = true;
+    }
+
+    template <typename Weight>
+    bool DirectedWeightedGraph<Weight>::IsFrozen() const {
+        return frozen_;
+    }
+
+    template <typename Weight>
+    size_t DirectedWeightedGraph<Weight>::GetVertexCount() const {
+        return vertex_count_;
+    }
 
     template <typename Weight>
     size_t DirectedWeightedGraph<Weight>::GetEdgeCount() const {
@@ -78,7 +174,14 @@ namespace graph {
     template <typename Weight>
     typename DirectedWeightedGraph<Weight>::IncidentEdgesRange
     DirectedWeightedGraph<Weight>::GetIncidentEdges(VertexId vertex) const {
-        return ranges::AsRange(incidence_lists_.at(vertex));
+        if (!frozen_) {
+            throw std::logic_error("Graph should be frozen before iterating incident edges");
+        }
+        if (vertex >= vertex_count_) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+        return {incident_edges_.begin() + incidence_offsets_[vertex],
+                incident_edges_.begin() + incidence_offsets_[vertex + 1]};
     }
 
     template <typename Weight>
@@ -87,7 +190,12 @@ namespace graph {
     }
 
     template <typename Weight>
-    const std::vector<typename DirectedWeightedGraph<Weight>::IncidenceList>& DirectedWeightedGraph<Weight>::GetIncidenceList() const {
-        return incidence_lists_;
+    const std::vector<size_t>& DirectedWeightedGraph<Weight>::GetIncidenceOffsets() const {
+        return incidence_offsets_;
+    }
+
+    template <typename Weight>
+    const typename DirectedWeightedGraph<Weight>::IncidenceList& DirectedWeightedGraph<Weight>::GetAllIncidentEdges() const {
+        return incident_edges_;
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,297 @@
+#pragma once
+
+#include "contraction_hierarchy.h"
+#include "graph.h"
+#include "router_engine.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+    // Разметка хабами (2-hop labeling): у каждой вершины есть прямая метка — хабы, достижимые из неё,
+    // и обратная — хабы, из которых достижима она сама. Кратчайший путь from -> to проходит через
+    // общий хаб прямой метки from и обратной метки to, поэтому запрос — слияние двух упорядоченных массивов.
+    // Метки строятся отсечённым поиском Дейкстры из вершин по убыванию важности Contraction Hierarchies
+    template <typename Weight>
+    class HubLabels : public RouterEngine<Weight> {
+    private:
+        using Graph = DirectedWeightedGraph<Weight>;
+
+    public:
+        using RouteInfo = graph::RouteInfo<Weight>;
+
+        // edge — ребро пути к родителю по дереву поиска из хаба: в прямой метке первое ребро пути
+        // от вершины к хабу, в обратной — последнее ребро пути от хаба. У самого хаба ребра нет
+        struct LabelEntry {
+            VertexId hub;
+            Weight weight;
+            EdgeId edge;
+        };
+
+        // Метки всех вершин подряд: метка вершины v — entries с offsets[v] по offsets[v + 1], упорядоченная по хабу
+        struct Labels {
+            std::vector<size_t> offsets;
+            std::vector<LabelEntry> entries;
+        };
+
+        static constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+
+        explicit HubLabels(const Graph& graph);
+
+        HubLabels(const Graph& graph, Labels&& forward_labels, Labels&& backward_labels);
+
+        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+        const Labels& GetForwardLabels() const;
+
+        const Labels& GetBackwardLabels() const;
+
+    private:
+        using QueueItem = std::pair<Weight, VertexId>;
+        using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+        using LabelLists = std::vector<std::vector<LabelEntry>>;
+
+        // Массивы поиска переиспользуются всеми запусками: после поиска сбрасываются только затронутые вершины
+        struct Search {
+            explicit Search(size_t vertex_count) : weights(vertex_count), edges(vertex_count, NO_EDGE), hub_weights(vertex_count) {
+            }
+
+            std::vector<std::optional<Weight>> weights;
+            std::vector<EdgeId> edges;
+            // Расстояния между хабом поиска и хабами его метки
+            std::vector<std::optional<Weight>> hub_weights;
+            std::vector<VertexId> touched;
+        };
+
+        // Поиск из hub по рёбрам get_incident_edges. Вершина, расстояние до которой уже покрыто
+        // найденными метками, не получает хаба и не раскрывается дальше
+        template <typename IncidentEdges>
+        static void RunPrunedSearch(VertexId hub, IncidentEdges get_incident_edges, const LabelLists& hub_labels,
+                                    LabelLists& vertex_labels, Search& search);
+
+        static Labels FlattenLabels(LabelLists& label_lists);
+
+        const LabelEntry& FindEntry(const Labels& labels, VertexId vertex, VertexId hub) const;
+
+        static constexpr Weight ZERO_WEIGHT{};
+        const Graph& graph_;
+        Labels forward_labels_;
+        Labels backward_labels_;
+    };
+
+    template <typename Weight>
+    HubLabels<Weight>::HubLabels(const Graph& graph) : graph_(graph) {
+        const size_t vertex_count = graph_.GetVertexCount();
+        for (const auto& edge : graph_.GetEdges()) {
+            if (edge.weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+        }
+        // Чем раньше хаб, тем больше путей он покрывает и тем короче метки остальных вершин
+        const std::vector<size_t> ranks = ContractionHierarchy<Weight>(graph_).GetRanks();
+        std::vector<VertexId> order(vertex_count);
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            order[vertex_count - 1 - ranks[vertex]] = vertex;
+        }
+
+        // Входящие рёбра в CSR по вершине-концу, поле to хранит начало ребра
+        std::vector<size_t> incoming_offsets(vertex_count + 1, 0);
+        for (const auto& edge : graph_.GetEdges()) {
+            ++incoming_offsets[edge.to + 1];
+        }
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            incoming_offsets[vertex + 1] += incoming_offsets[vertex];
+        }
+        typename Graph::IncidenceList incoming_edges(graph_.GetEdgeCount());
+        std::vector<size_t> positions(incoming_offsets.begin(), incoming_offsets.end() - 1);
+        for (EdgeId id = 0; id < graph_.GetEdgeCount(); ++id) {
+            const auto& edge = graph_.GetEdge(id);
+            incoming_edges[positions[edge.to]++] = {id, edge.from, edge.weight};
+        }
+        auto get_outgoing_edges = [this](VertexId vertex) {
+            return graph_.GetIncidentEdges(vertex);
+        };
+        auto get_incoming_edges = [&](VertexId vertex) {
+            return typename Graph::IncidentEdgesRange{incoming_edges.begin() + incoming_offsets[vertex],
+                                                      incoming_edges.begin() + incoming_offsets[vertex + 1]};
+        };
+
+        // Поиск вперёд из хаба дополняет обратные метки достигнутых вершин, поиск назад — прямые
+        LabelLists forward_lists(vertex_count);
+        LabelLists backward_lists(vertex_count);
+        Search search(vertex_count);
+        for (const VertexId hub : order) {
+            RunPrunedSearch(hub, get_outgoing_edges, forward_lists, backward_lists, search);
+            RunPrunedSearch(hub, get_incoming_edges, backward_lists, forward_lists, search);
+        }
+        forward_labels_ = FlattenLabels(forward_lists);
+        backward_labels_ = FlattenLabels(backward_lists);
+    }
+
+    template <typename Weight>
+    HubLabels<Weight>::HubLabels(const Graph& graph, Labels&& forward_labels, Labels&& backward_labels)
+            : graph_(graph)
+            , forward_labels_(std::move(forward_labels))
+            , backward_labels_(std::move(backward_labels)) {
+        for (const Labels* labels : {&forward_labels_, &backward_labels_}) {
+            if (labels->offsets.size() != graph_.GetVertexCount() + 1 || labels->offsets.back() != labels->entries.size()) {
+                throw std::invalid_argument("Labels don't match vertex count");
+            }
+        }
+    }
+
+    template <typename Weight>
+    template <typename IncidentEdges>
+    void HubLabels<Weight>::RunPrunedSearch(VertexId hub, IncidentEdges get_incident_edges, const LabelLists& hub_labels,
+                                            LabelLists& vertex_labels, Search& search) {
+        for (const auto& entry : hub_labels[hub]) {
+            search.hub_weights[entry.hub] = entry.weight;
+        }
+        Queue queue;
+        search.weights[hub] = ZERO_WEIGHT;
+        search.touched.push_back(hub);
+        queue.push({ZERO_WEIGHT, hub});
+        while (!queue.empty()) {
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+            if (weight > *search.weights[vertex]) {
+                continue;
+            }
+            const bool is_covered = std::any_of(vertex_labels[vertex].begin(), vertex_labels[vertex].end(),
+                                                [&](const LabelEntry& entry) {
+                                                    const auto& hub_weight = search.hub_weights[entry.hub];
+                                                    return hub_weight && *hub_weight + entry.weight <= weight;
+                                                });
+            if (is_covered) {
+                continue;
+            }
+            vertex_labels[vertex].push_back({hub, weight, search.edges[vertex]});
+            for (const auto& edge : get_incident_edges(vertex)) {
+                const Weight candidate_weight = weight + edge.weight;
+                auto& edge_weight = search.weights[edge.to];
+                if (!edge_weight) {
+                    search.touched.push_back(edge.to);
+                } else if (candidate_weight >= *edge_weight) {
+                    continue;
+                }
+                edge_weight = candidate_weight;
+                search.edges[edge.to] = edge.id;
+                queue.push({candidate_weight, edge.to});
+            }
+        }
+
+        for (const VertexId vertex : search.touched) {
+            search.weights[vertex].reset();
+            search.edges[vertex] = NO_EDGE;
+        }
+        search.touched.clear();
+        for (const auto& entry : hub_labels[hub]) {
+            search.hub_weights[entry.hub].reset();
+        }
+    }
+
+    template <typename Weight>
+    typename HubLabels<Weight>::Labels HubLabels<Weight>::FlattenLabels(LabelLists& label_lists) {
+        Labels labels;
+        labels.offsets.reserve(label_lists.size() + 1);
+        labels.offsets.push_back(0);
+        for (auto& label : label_lists) {
+            std::sort(label.begin(), label.end(), [](const LabelEntry& lhs, const LabelEntry& rhs) {
+                return lhs.hub < rhs.hub;
+            });
+            labels.entries.insert(labels.entries.end(), label.begin(), label.end());
+            labels.offsets.push_back(labels.entries.size());
+            label = {};
+        }
+        return labels;
+    }
+
+    template <typename Weight>
+    const typename HubLabels<Weight>::LabelEntry& HubLabels<Weight>::FindEntry(const Labels& labels, VertexId vertex,
+                                                                              VertexId hub) const {
+        const auto begin = labels.entries.begin() + labels.offsets[vertex];
+        const auto end = labels.entries.begin() + labels.offsets[vertex + 1];
+        const auto it = std::lower_bound(begin, end, hub, [](const LabelEntry& entry, VertexId value) {
+            return entry.hub < value;
+        });
+        if (it == end || it->hub != hub) {
+            throw std::logic_error("Hub label has no parent entry");
+        }
+        return *it;
+    }
+
+    template <typename Weight>
+    std::optional<typename HubLabels<Weight>::RouteInfo> HubLabels<Weight>::BuildRoute(VertexId from, VertexId to) const {
+        const size_t vertex_count = graph_.GetVertexCount();
+        if (from >= vertex_count || to >= vertex_count) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+
+        std::optional<Weight> best_weight;
+        VertexId best_hub = 0;
+        size_t forward = forward_labels_.offsets[from];
+        size_t backward = backward_labels_.offsets[to];
+        const size_t forward_end = forward_labels_.offsets[from + 1];
+        const size_t backward_end = backward_labels_.offsets[to + 1];
+        while (forward < forward_end && backward < backward_end) {
+            const LabelEntry& forward_entry = forward_labels_.entries[forward];
+            const LabelEntry& backward_entry = backward_labels_.entries[backward];
+            if (forward_entry.hub < backward_entry.hub) {
+                ++forward;
+            } else if (backward_entry.hub < forward_entry.hub) {
+                ++backward;
+            } else {
+                const Weight weight = forward_entry.weight + backward_entry.weight;
+                if (!best_weight || weight < *best_weight) {
+                    best_weight = weight;
+                    best_hub = forward_entry.hub;
+                }
+                ++forward;
+                ++backward;
+            }
+        }
+        if (!best_weight) {
+            return std::nullopt;
+        }
+
+        // Путь восстанавливается по родителям в деревьях поиска из best_hub: от from вперёд до хаба
+        // и от to назад до хаба. Родитель вершины раскрывался при поиске, поэтому тоже хранит этот хаб
+        std::vector<EdgeId> edges;
+        for (VertexId vertex = from; vertex != best_hub;) {
+            const EdgeId edge_id = FindEntry(forward_labels_, vertex, best_hub).edge;
+            edges.push_back(edge_id);
+            vertex = graph_.GetEdge(edge_id).to;
+        }
+        const size_t hub_position = edges.size();
+        for (VertexId vertex = to; vertex != best_hub;) {
+            const EdgeId edge_id = FindEntry(backward_labels_, vertex, best_hub).edge;
+            edges.push_back(edge_id);
+            vertex = graph_.GetEdge(edge_id).from;
+        }
+        std::reverse(edges.begin() + hub_position, edges.end());
+
+        Weight weight = ZERO_WEIGHT;
+        for (const EdgeId edge_id : edges) {
+            weight += graph_.GetEdge(edge_id).weight;
+        }
+        return RouteInfo{weight, std::move(edges)};
+    }
+
+    template <typename Weight>
+    const typename HubLabels<Weight>::Labels& HubLabels<Weight>::GetForwardLabels() const {
+        return forward_labels_;
+    }
+
+    template <typename Weight>
+    const typename HubLabels<Weight>::Labels& HubLabels<Weight>::GetBackwardLabels() const {
+        return backward_labels_;
+    }
+
+}
@@ -46,8 +46,82 @@ namespace json_reader {
     }
 
     void JsonReader::LoadRoutingSettings(const std::map<std::string, json::Node>& info) {
-        catalogue_->SetRoutingSettings(transport_catalogue::RoutingSettings{info.at("bus_wait_time").AsInt(),
-                                                                           info.at("bus_velocity").AsDouble()});
+        transport_catalogue::RoutingSettings routing_settings{info.at("bus_wait_time").AsInt(),
+                                                              info.at("bus_velocity").AsDouble()};
+        if (info.count("router_type")) {
+            routing_settings.router_type_ = LoadRouterType(info.at("router_type").AsString());
+        }
+        if (info.count("graph_model")) {
+            routing_settings.graph_model_ = LoadGraphModel(info.at("graph_model").AsString());
+        }
+        if (info.count("vertex_order")) {
+            routing_settings.vertex_order_ = LoadVertexOrder(info.at("vertex_order").AsString());
+        }
+        if (info.count("prune_parallel_edges")) {
+            routing_settings.prune_parallel_edges_ = info.at("prune_parallel_edges").AsBool();
+        }
+        if (info.count("route_cache_capacity")) {
+            const int capacity = info.at("route_cache_capacity").AsInt();
+            if (capacity < 0) {
+                throw std::invalid_argument("route_cache_capacity should be non-negative");
+            }
+            routing_settings.route_cache_capacity_ = static_cast<size_t>(capacity);
+        }
+        catalogue_->SetRoutingSettings(routing_settings);
+    }
+
+    transport_catalogue::RouterType JsonReader::LoadRouterType(const std::string& name) {
+        if (name == "floyd_warshall") {
+            return transport_catalogue::RouterType::FLOYD_WARSHALL;
+        }
+        if (name == "floyd_warshall_blocked") {
+            return transport_catalogue::RouterType::FLOYD_WARSHALL_BLOCKED;
+        }
+        if (name == "contraction_hierarchies") {
+            return transport_catalogue::RouterType::CONTRACTION_HIERARCHIES;
+        }
+        if (name == "raptor") {
+            return transport_catalogue::RouterType::RAPTOR;
+        }
+        if (name == "dijkstra") {
+            return transport_catalogue::RouterType::DIJKSTRA;
+        }
+        if (name == "a_star") {
+            return transport_catalogue::RouterType::A_STAR;
+        }
+        if (name == "bidirectional_dijkstra") {
+            return transport_catalogue::RouterType::BIDIRECTIONAL_DIJKSTRA;
+        }
+        if (name == "hub_labels") {
+            return transport_catalogue::RouterType::HUB_LABELS;
+        }
+        throw std::invalid_argument("Unknown router_type: " + name);
+    }
+
+    transport_catalogue::GraphModel JsonReader::LoadGraphModel(const std::string& name) {
+        if (name == "stop_pairs") {
+            return transport_catalogue::GraphModel::STOP_PAIRS;
+        }
+        if (name == "line_graph") {
+            return transport_catalogue::GraphModel::LINE_GRAPH;
+        }
+        if (name == "single_vertex") {
+            return transport_catalogue::GraphModel::SINGLE_VERTEX;
+        }
+        throw std::invalid_argument("Unknown graph_model: " + name);
+    }
+
+    transport_catalogue::VertexOrder JsonReader::LoadVertexOrder(const std::string& name) {
+        if (name == "none") {
+            return transport_catalogue::VertexOrder::NONE;
+        }
+        if (name == "rcm") {
+            return transport_catalogue::VertexOrder::RCM;
+        }
+        if (name == "hilbert") {
+            return transport_catalogue::VertexOrder::HILBERT;
+        }
+        throw std::invalid_argument("Unknown vertex_order: " + name);
     }
 
     void JsonReader::LoadDataFromJson() {
@@ -59,7 +133,12 @@ namespace json_reader {
             }
             if (temp.first == "base_requests") {
                 auto base_request = temp.second.AsArray();
-                InputDataToCatalogue(base_request);
+                // Без справочника запросы сохраняются для UpdateCatalogue
+                if (catalogue_) {
+                    InputDataToCatalogue(base_request);
+                } else {
+                    base_requests_ = std::move(base_request);
+                }
             }
             if (temp.first == "render_settings") {
                 auto render_settings = temp.second.AsMap();
@@ -118,6 +197,11 @@ namespace json_reader {
     }
 
     void JsonReader::LoadBuses(const std::map<std::string, json::Node>& document) {
+        auto* ptr = &buses_.emplace_back(ParseBus(document));
+        catalogue_->AddBus(ptr->name, ptr);
+    }
+
+    transport_catalogue::bus::Bus JsonReader::ParseBus(const std::map<std::string, json::Node>& document) {
         const json::Array& stops = document.at("stops").AsArray();
         transport_catalogue::bus::Bus bus;
         bus.name = document.at("name").AsString();
@@ -125,8 +209,36 @@ namespace json_reader {
         for (const auto& stop: stops) {
             bus.route.emplace_back(catalogue_->FindStop(stop.AsString()));
         }
-        auto* ptr = &buses_.emplace_back(bus);
-        catalogue_->AddBus(ptr->name, ptr);
+        return bus;
+    }
+
+    void JsonReader::UpdateCatalogue(transport_catalogue::TransportCatalogue& catalogue, transport_router::TransportRouter& router) {
+        catalogue_ = &catalogue;
+        router_ = &router;
+        std::deque<std::map<std::string, json::Node>const *> buses;
+        for (auto& request: base_requests_) {
+            const auto& info = request.AsMap();
+            if (info.at("type").AsString() == "Stop") {
+                if (catalogue.FindStop(info.at("name").AsString())) {
+                    for (const auto& [stop_to, distance] : info.at("road_distances").AsMap()) {
+                        distance_between_stops_.push_back({info.at("name").AsString(), stop_to, distance.AsInt()});
+                    }
+                } else {
+                    LoadStops(info);
+                    router.AddStop(catalogue, &stops_.back());
+                }
+            }
+            if (info.at("type").AsString() == "Bus") {
+                buses.push_back(&info);
+            }
+        }
+        for (auto& stop: distance_between_stops_) {
+            router.SetDistance(catalogue, catalogue.FindStop(stop.stop_1), catalogue.FindStop(stop.stop_2), stop.distance);
+        }
+        for (auto& bus: buses) {
+            router.AddBus(catalogue, &buses_.emplace_back(ParseBus(*bus)));
+        }
+        router.ApplyUpdates(catalogue);
     }
 
     void JsonReader::BuildJsonBus(json::Builder& builder, const std::map<std::string, json::Node>& document) {
@@ -189,27 +301,211 @@ namespace json_reader {
         builder.StartDict().Key("request_id").Value(document.at("id").AsInt()).Key("error_message").Value(std::string{"not found"}).EndDict();
     }
 
-    void JsonReader::BuildJsonRoute(json::Builder& builder, const RouteRequest& request, transport_catalogue::TransportCatalogue catalogue, transport_router::TransportRouter& router) {
-        if (catalogue_->FindStop(request.from) && catalogue_->FindStop(request.to)) {
-            std::optional<StopPairVertexId> pair_vertex_id_stop_from = router.GetPairVertexId(catalogue.FindStop(request.from));
-            std::optional<StopPairVertexId> pair_vertex_id_stop_to = router.GetPairVertexId(catalogue.FindStop(request.to));
-            std::optional<RouteInfo> route_info = router.GetRouteInfo(pair_vertex_id_stop_from->bus_wait_begin, pair_vertex_id_stop_to->bus_wait_begin);
-            if (route_info) {
-                builder.StartDict().Key("request_id"s).Value(request.id).Key("total_time"s).Value(route_info->total_time).Key("items"s).StartArray();
-                for (auto& info : route_info->edges) {
-                    if (info.index() == 1) {
-                        BuildJsonBusEdge(builder, std::get<BusEdgeInfo>(info));
-                    } else {
-                        BuildJsonWaitEdge(builder, std::get<WaitEdgeInfo>(info));
-                    }
-                }
-                builder.EndArray().EndDict();
-            } else {
-                ErrorMessage(builder, request.id);
+    // Запросы маршрутов группируются по остановке отправления: на каждую группу строится
+    // одно дерево кратчайших путей. Запросы со своими настройками маршрутизации считаются по одному.
+    // Ключ результата — номер запроса в stat_requests
+    std::unordered_map<size_t, std::optional<RouteInfo>> JsonReader::BuildRouteInfos() {
+        std::unordered_map<size_t, std::optional<RouteInfo>> route_infos;
+        std::unordered_map<graph::VertexId, std::vector<size_t>> requests_by_source;
+        std::unordered_map<graph::VertexId, std::vector<graph::VertexId>> targets_by_source;
+        std::vector<graph::VertexId> sources;
+        for (size_t i = 0; i < json_data_.size(); ++i) {
+            const auto& request = json_data_[i].AsMap();
+            if (request.at("type").AsString() != "Route") {
+                continue;
+            }
+            auto* stop_from = catalogue_->FindStop(request.at("from"s).AsString());
+            auto* stop_to = catalogue_->FindStop(request.at("to"s).AsString());
+            if (!stop_from || !stop_to) {
+                continue;
+            }
+            const graph::VertexId from = router_->GetPairVertexId(stop_from)->bus_wait_begin;
+            const graph::VertexId to = router_->GetPairVertexId(stop_to)->bus_wait_begin;
+            if (const auto settings = LoadRequestRoutingSettings(request)) {
+                route_infos[i] = router_->GetRouteInfo(from, to, *settings);
+                continue;
+            }
+            if (!requests_by_source.count(from)) {
+                sources.push_back(from);
+            }
+            requests_by_source[from].push_back(i);
+            targets_by_source[from].push_back(to);
+        }
+
+        for (const graph::VertexId from : sources) {
+            std::vector<std::optional<RouteInfo>> routes = router_->GetRouteInfos(from, targets_by_source.at(from));
+            const std::vector<size_t>& requests = requests_by_source.at(from);
+            for (size_t i = 0; i < requests.size(); ++i) {
+                route_infos[requests[i]] = std::move(routes[i]);
             }
+        }
+        return route_infos;
+    }
+
+    // Пусто, если запрос не меняет базовых времени ожидания и скорости
+    std::optional<transport_catalogue::RoutingSettings> JsonReader::LoadRequestRoutingSettings(const std::map<std::string, json::Node>& request) {
+        if (!request.count("routing_settings"s)) {
+            return std::nullopt;
+        }
+        const transport_catalogue::RoutingSettings& base_settings = router_->GetRoutingSettings();
+        transport_catalogue::RoutingSettings settings = base_settings;
+        const auto& info = request.at("routing_settings"s).AsMap();
+        if (info.count("bus_wait_time"s)) {
+            settings.bus_wait_time_ = info.at("bus_wait_time"s).AsInt();
+        }
+        if (info.count("bus_velocity"s)) {
+            settings.bus_velocity_ = info.at("bus_velocity"s).AsDouble();
+        }
+        if (settings.bus_wait_time_ < 0 || settings.bus_velocity_ <= 0) {
+            throw std::invalid_argument("Route routing_settings should have non-negative bus_wait_time and positive bus_velocity");
+        }
+        if (settings.bus_wait_time_ == base_settings.bus_wait_time_ && settings.bus_velocity_ == base_settings.bus_velocity_) {
+            return std::nullopt;
+        }
+        return settings;
+    }
+
+    void JsonReader::BuildJsonRoute(json::Builder& builder, int id, const std::optional<RouteInfo>& route_info) {
+        if (route_info) {
+            builder.StartDict().Key("request_id"s).Value(id).Key("total_time"s).Value(route_info->total_time);
+            BuildJsonRouteItems(builder, *route_info);
+            builder.EndDict();
         } else {
-            ErrorMessage(builder, request.id);
+            ErrorMessage(builder, id);
+        }
+    }
+
+    void JsonReader::BuildJsonRouteItems(json::Builder& builder, const RouteInfo& route_info) {
+        builder.Key("items"s).StartArray();
+        for (auto& info : route_info.edges) {
+            if (info.index() == 1) {
+                BuildJsonBusEdge(builder, std::get<BusEdgeInfo>(info));
+            } else {
+                BuildJsonWaitEdge(builder, std::get<WaitEdgeInfo>(info));
+            }
         }
+        builder.EndArray();
+    }
+
+    // Варианты маршрута, оптимальные по Парето: каждый следующий быстрее, но с большим числом пересадок
+    void JsonReader::BuildJsonParetoRoute(json::Builder& builder, const std::map<std::string, json::Node>& document) {
+        const int id = document.at("id"s).AsInt();
+        auto* stop_from = catalogue_->FindStop(document.at("from"s).AsString());
+        auto* stop_to = catalogue_->FindStop(document.at("to"s).AsString());
+        if (!stop_from || !stop_to) {
+            ErrorMessage(builder, id);
+            return;
+        }
+        const std::vector<RouteInfo> route_infos = router_->GetParetoRouteInfos(router_->GetPairVertexId(stop_from)->bus_wait_begin,
+                                                                                router_->GetPairVertexId(stop_to)->bus_wait_begin);
+        if (route_infos.empty()) {
+            ErrorMessage(builder, id);
+            return;
+        }
+        builder.StartDict().Key("request_id"s).Value(id).Key("routes"s).StartArray();
+        for (const auto& route_info : route_infos) {
+            const auto bus_count = std::count_if(route_info.edges.begin(), route_info.edges.end(), [](const EdgeInfo& info) {
+                return std::holds_alternative<BusEdgeInfo>(info);
+            });
+            builder.StartDict().Key("total_time"s).Value(route_info.total_time)
+                    .Key("transfer_count"s).Value(static_cast<int>(std::max<std::ptrdiff_t>(bus_count - 1, 0)));
+            BuildJsonRouteItems(builder, route_info);
+            builder.EndDict();
+        }
+        builder.EndArray().EndDict();
+    }
+
+    void JsonReader::BuildJsonAlternativeRoutes(json::Builder& builder, const std::map<std::string, json::Node>& document) {
+        const int id = document.at("id"s).AsInt();
+        const int count = document.at("count"s).AsInt();
+        if (count <= 0) {
+            throw std::invalid_argument("AlternativeRoutes count should be positive");
+        }
+        auto* stop_from = catalogue_->FindStop(document.at("from"s).AsString());
+        auto* stop_to = catalogue_->FindStop(document.at("to"s).AsString());
+        if (!stop_from || !stop_to) {
+            ErrorMessage(builder, id);
+            return;
+        }
+        const std::vector<RouteInfo> route_infos = router_->GetAlternativeRouteInfos(router_->GetPairVertexId(stop_from)->bus_wait_begin,
+                                                                                     router_->GetPairVertexId(stop_to)->bus_wait_begin,
+                                                                                     static_cast<size_t>(count));
+        if (route_infos.empty()) {
+            ErrorMessage(builder, id);
+            return;
+        }
+        builder.StartDict().Key("request_id"s).Value(id).Key("routes"s).StartArray();
+        for (const auto& route_info : route_infos) {
+            builder.StartDict().Key("total_time"s).Value(route_info.total_time);
+            BuildJsonRouteItems(builder, route_info);
+            builder.EndDict();
+        }
+        builder.EndArray().EndDict();
+    }
+
+    // С ключом render_map к ответу прикладывается карта, на которой достижимые остановки закрашены по времени прибытия
+    void JsonReader::BuildJsonReachable(json::Builder& builder, const std::map<std::string, json::Node>& document) {
+        const int id = document.at("id"s).AsInt();
+        const double max_time = document.at("max_time"s).AsDouble();
+        if (max_time < 0) {
+            throw std::invalid_argument("Reachable max_time should be non-negative");
+        }
+        auto* stop = catalogue_->FindStop(document.at("stop"s).AsString());
+        if (!stop) {
+            ErrorMessage(builder, id);
+            return;
+        }
+        const std::vector<ReachableStop> reachable_stops = router_->GetReachableStops(router_->GetPairVertexId(stop)->bus_wait_begin, max_time);
+        builder.StartDict().Key("request_id"s).Value(id).Key("stops"s).StartArray();
+        for (const auto& reachable_stop : reachable_stops) {
+            builder.StartDict().Key("stop_name"s).Value(std::string(reachable_stop.stop_name))
+                    .Key("time"s).Value(reachable_stop.time).EndDict();
+        }
+        builder.EndArray();
+        if (document.count("render_map"s) && document.at("render_map"s).AsBool()) {
+            map_renderer::MapRenderer renderer{map_renderer::RenderSettings(settings_)};
+            renderer.SetReachableStops(reachable_stops, max_time);
+            renderer.RenderMap(*catalogue_);
+            builder.Key("map"s).Value(renderer.GetMapAsString());
+        }
+        builder.EndDict();
+    }
+
+    // Строка на каждую остановку sources, столбец на каждую targets; null — маршрута нет или остановка не найдена
+    void JsonReader::BuildJsonMatrix(json::Builder& builder, const std::map<std::string, json::Node>& document) {
+        // Движку передаются только найденные остановки, positions — их номера среди переданных
+        auto load_vertices = [this](const json::Array& names, std::vector<graph::VertexId>& vertices,
+                                    std::vector<std::optional<size_t>>& positions) {
+            for (const auto& name : names) {
+                if (auto* stop = catalogue_->FindStop(name.AsString())) {
+                    positions.push_back(vertices.size());
+                    vertices.push_back(router_->GetPairVertexId(stop)->bus_wait_begin);
+                } else {
+                    positions.push_back(std::nullopt);
+                }
+            }
+        };
+        std::vector<graph::VertexId> sources;
+        std::vector<std::optional<size_t>> source_positions;
+        load_vertices(document.at("sources"s).AsArray(), sources, source_positions);
+        std::vector<graph::VertexId> targets;
+        std::vector<std::optional<size_t>> target_positions;
+        load_vertices(document.at("targets"s).AsArray(), targets, target_positions);
+
+        const auto total_times = router_->GetTravelTimeMatrix(sources, targets);
+        builder.StartDict().Key("request_id"s).Value(document.at("id"s).AsInt()).Key("total_times"s).StartArray();
+        for (const auto& source_position : source_positions) {
+            builder.StartArray();
+            for (const auto& target_position : target_positions) {
+                if (source_position && target_position && total_times[*source_position][*target_position]) {
+                    builder.Value(*total_times[*source_position][*target_position]);
+                } else {
+                    builder.Value(nullptr);
+                }
+            }
+            builder.EndArray();
+        }
+        builder.EndArray().EndDict();
     }
 
     void JsonReader::ErrorMessage(json::Builder& builder, int id) {
@@ -241,7 +537,9 @@ namespace json_reader {
         if (json_data_.empty()) {
             return;
         }
-        for (auto& request: json_data_) {
+        std::unordered_map<size_t, std::optional<RouteInfo>> route_infos = BuildRouteInfos();
+        for (size_t i = 0; i < json_data_.size(); ++i) {
+            const auto& request = json_data_[i];
             if (request.AsMap().at("type").AsString() == "Map") {
                 builder.StartDict().Key("map").Value(map_).Key("request_id").Value(request.AsMap().at("id").AsInt()).EndDict();
             }
@@ -252,8 +550,21 @@ namespace json_reader {
                 BuildJsonBus(builder, request.AsMap());
             }
             if (request.AsMap().at("type").AsString() == "Route") {
-                RouteRequest router_request{request.AsMap().at("from"s).AsString(), request.AsMap().at("to"s).AsString(), (request.AsMap().at("id"s).AsInt())};
-                BuildJsonRoute(builder, router_request, *catalogue_, *router_);
+                const auto route_info = route_infos.find(i);
+                BuildJsonRoute(builder, request.AsMap().at("id"s).AsInt(),
+                               route_info != route_infos.end() ? route_info->second : std::nullopt);
+            }
+            if (request.AsMap().at("type").AsString() == "ParetoRoute") {
+                BuildJsonParetoRoute(builder, request.AsMap());
+            }
+            if (request.AsMap().at("type").AsString() == "AlternativeRoutes") {
+                BuildJsonAlternativeRoutes(builder, request.AsMap());
+            }
+            if (request.AsMap().at("type").AsString() == "Reachable") {
+                BuildJsonReachable(builder, request.AsMap());
+            }
+            if (request.AsMap().at("type").AsString() == "Matrix") {
+                BuildJsonMatrix(builder, request.AsMap());
             }
         }
         builder.EndArray();
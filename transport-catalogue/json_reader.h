@@ -34,6 +34,12 @@ namespace json_reader {
 
         void LoadRoutingSettings(const std::map<std::string, json::Node>& info);
 
+        transport_catalogue::RouterType LoadRouterType(const std::string& name);
+
+        transport_catalogue::GraphModel LoadGraphModel(const std::string& name);
+
+        transport_catalogue::VertexOrder LoadVertexOrder(const std::string& name);
+
         void LoadDataFromJson();
 
         void InputDataToCatalogue(const std::vector<json::Node>& info);
@@ -42,13 +48,34 @@ namespace json_reader {
 
         void LoadBuses(const std::map<std::string, json::Node>& document);
 
+        transport_catalogue::bus::Bus ParseBus(const std::map<std::string, json::Node>& document);
+
+        // Применяет base_requests к уже построенным справочнику и маршрутизатору: добавляет новые
+        // остановки и автобусы и меняет расстояния, не перестраивая маршрутизатор с нуля
+        void UpdateCatalogue(transport_catalogue::TransportCatalogue& catalogue, transport_router::TransportRouter& router);
+
         void BuildJsonBus(json::Builder& builder, const std::map<std::string, json::Node>& document);
 
         void BuildJsonStop(json::Builder& builder, const std::map<std::string, json::Node>& document);
 
         void LoadRequest(const std::vector<json::Node>& info);
 
-        void BuildJsonRoute(json::Builder& builder, const RouteRequest& request, transport_catalogue::TransportCatalogue catalogue, transport_router::TransportRouter& router);
+        std::unordered_map<size_t, std::optional<RouteInfo>> BuildRouteInfos();
+
+        // Настройки маршрутизации запроса: базовые с заменёнными в его routing_settings значениями
+        std::optional<transport_catalogue::RoutingSettings> LoadRequestRoutingSettings(const std::map<std::string, json::Node>& request);
+
+        void BuildJsonRoute(json::Builder& builder, int id, const std::optional<RouteInfo>& route_info);
+
+        void BuildJsonRouteItems(json::Builder& builder, const RouteInfo& route_info);
+
+        void BuildJsonParetoRoute(json::Builder& builder, const std::map<std::string, json::Node>& document);
+
+        void BuildJsonAlternativeRoutes(json::Builder& builder, const std::map<std::string, json::Node>& document);
+
+        void BuildJsonReachable(json::Builder& builder, const std::map<std::string, json::Node>& document);
+
+        void BuildJsonMatrix(json::Builder& builder, const std::map<std::string, json::Node>& document);
 
         void BuildJsonWaitEdge(json::Builder& builder, const WaitEdgeInfo& wait_edge_info);
 
@@ -66,8 +93,8 @@ namespace json_reader {
         void OutputRequest(transport_catalogue::TransportCatalogue* catalogue);
 
     private:
-        transport_router::TransportRouter* router_;
-        transport_catalogue::TransportCatalogue* catalogue_;
+        transport_router::TransportRouter* router_ = nullptr;
+        transport_catalogue::TransportCatalogue* catalogue_ = nullptr;
         std::deque<transport_catalogue::stop::Stop> stops_;
         std::deque<Distance> distance_between_stops_;
         const json::Node& document_;
@@ -77,5 +104,6 @@ namespace json_reader {
         SerializationSettings serializationsettings_;
         SerializationSettings GetSerializationSettingsFromJson();
         std::vector<json::Node> json_data_;
+        std::vector<json::Node> base_requests_;
     };
 }
\ No newline at end of file
@@ -14,7 +14,14 @@
 using namespace std::literals;
 
 void PrintUsage(std::ostream& stream = std::cerr) {
-    stream << "Usage: transport_catalogue [make_base|process_requests]\n"sv;
+    stream << "Usage: transport_catalogue [make_base|process_requests|update_base]\n"sv;
+}
+
+// Размер базы на вершину графа позволяет сравнивать предрасчёт движков: таблицу маршрутов, метки хабов и т.д.
+void PrintBaseSize(std::ostream& output, size_t vertex_count) {
+    const auto base_size = static_cast<size_t>(output.tellp());
+    std::cerr << "Base size: "sv << base_size << " bytes, "sv << vertex_count << " graph vertices ("sv
+              << (vertex_count > 0 ? base_size / vertex_count : 0) << " bytes per vertex)\n"sv;
 }
 
 using namespace std;
@@ -32,6 +39,10 @@ int main(int argc, char* argv[]) {
         transport_router::TransportRouter router(transport_catalogue.GetRoutingSettings());
         json_reader::JsonReader json_reader(transport_catalogue, json::Load(std::cin).GetRoot(), &router);
         router.BuildTransportRouter(transport_catalogue);
+        if (transport_catalogue.GetRoutingSettings().prune_parallel_edges_) {
+            std::cerr << "Pruned parallel edges: "sv << router.GetPrunedEdgeCount() << ", kept: "sv
+                      << router.GetGraph().GetEdgeCount() << "\n"sv;
+        }
 
         serial_handler::SerialHandler serial_handler(json_reader.GetSerializationSettings());
         std::ofstream output(serial_handler.GetSettings().name_file, std::ios::binary);
@@ -39,22 +50,47 @@ int main(int argc, char* argv[]) {
         serial_handler.SerializationMapRenderSettings(json_reader.GetMapRenderSettings());
         serial_handler.SerializationTransportRouter(router);
         serial_handler.Serialization(output);
+        PrintBaseSize(output, router.GetGraph().GetVertexCount());
         output.close();
     } else if (mode == "process_requests"sv) {
         json_reader::JsonReader json_reader(json::Load(std::cin).GetRoot());
         serial_handler::SerialHandler serial_handler(move(json_reader.GetSerializationSettings()));
-        std::ifstream input(serial_handler.GetSettings().name_file, std::ios::binary);
-        serial_handler.Deserialize(input);
+        serial_handler.DeserializeMapped();
         transport_catalogue::TransportCatalogue transport_catalogue = serial_handler.GetTransportCatalogue();
         transport_router::TransportRouter transport_router = serial_handler.GetTransportRouter(transport_catalogue);
         auto temp = transport_router.GetRoutingSettings();
         map_renderer::MapRenderer map_renderer(move(serial_handler.GetMapRenderSettings()));
         map_renderer.RenderMap(transport_catalogue);
         json_reader.SetMap(map_renderer.GetMapAsString());
+        json_reader.GetMapRenderSettings() = map_renderer.GetRenderSettings();
         transport_router.GetRoutingSettings() = temp;
         json_reader.SetTransportRouter(&transport_router);
         json_reader.OutputRequest(&transport_catalogue);
+        if (const auto stats = transport_router.GetSearchStats(); stats && stats->query_count > 0) {
+            std::cerr << "Route queries: "sv << stats->query_count << ", settled vertices: "sv << stats->settled_count
+                      << " ("sv << stats->settled_count / stats->query_count << " per query)\n"sv;
+        }
+        if (const auto stats = transport_router.GetRouteCacheStats()) {
+            std::cerr << "Route cache hits: "sv << stats->hits << ", misses: "sv << stats->misses << "\n"sv;
+        }
+
+    } else if (mode == "update_base"sv) {
+        json_reader::JsonReader json_reader(json::Load(std::cin).GetRoot());
+        serial_handler::SerialHandler serial_handler(json_reader.GetSerializationSettings());
+        std::ifstream input(serial_handler.GetSettings().name_file, std::ios::binary);
+        serial_handler.Deserialize(input);
+        input.close();
+        transport_catalogue::TransportCatalogue transport_catalogue = serial_handler.GetTransportCatalogue();
+        transport_router::TransportRouter transport_router = serial_handler.GetTransportRouter(transport_catalogue);
+        json_reader.UpdateCatalogue(transport_catalogue, transport_router);
 
+        serial_handler::SerialHandler output_handler(json_reader.GetSerializationSettings());
+        std::ofstream output(output_handler.GetSettings().name_file, std::ios::binary);
+        output_handler.SerializationTransportCatalogue(transport_catalogue);
+        output_handler.SerializationMapRenderSettings(serial_handler.GetMapRenderSettings());
+        output_handler.SerializationTransportRouter(transport_router);
+        output_handler.Serialization(output);
+        output.close();
     } else {
         PrintUsage();
         return 1;
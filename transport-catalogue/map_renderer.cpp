@@ -146,11 +146,28 @@ namespace map_renderer {
         for (auto& stop : all_stops_) {
             circle.SetCenter(proj(stop->coordinates))
                     .SetRadius(settings_.stop_radius)
-                    .SetFillColor("white");
+                    .SetFillColor(GetStopColor(stop->name));
             map_.Add(move(circle));
         }
     }
 
+    void MapRenderer::SetReachableStops(const std::vector<ReachableStop>& reachable_stops, double max_time) {
+        reachable_times_.clear();
+        for (const auto& reachable_stop : reachable_stops) {
+            reachable_times_[reachable_stop.stop_name] = reachable_stop.time;
+        }
+        max_reachable_time_ = max_time;
+    }
+
+    svg::Color MapRenderer::GetStopColor(std::string_view name) const {
+        const auto it = reachable_times_.find(name);
+        if (it == reachable_times_.end()) {
+            return "white"s;
+        }
+        const double share = max_reachable_time_ > 0 ? std::clamp(it->second / max_reachable_time_, 0.0, 1.0) : 0.0;
+        return svg::Rgb{static_cast<unsigned long>(255 * share), static_cast<unsigned long>(255 * (1 - share)), 0};
+    }
+
     void MapRenderer::GetAllStops() {
         for (auto& name : name_of_buses) {
             auto& stops = buses_.at(name)->route;
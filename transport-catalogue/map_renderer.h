@@ -107,6 +107,10 @@ namespace map_renderer {
 
         void RenderMap(transport_catalogue::TransportCatalogue& transport_catalogue);
 
+        // Задаётся до RenderMap: достижимые остановки закрашиваются по времени прибытия
+        // от зелёного у отправления до красного на границе max_time, остальные остаются белыми
+        void SetReachableStops(const std::vector<ReachableStop>& reachable_stops, double max_time);
+
         std::string GetMapAsString() const;
 
         const RenderSettings& GetRenderSettings() const;
@@ -117,6 +121,8 @@ namespace map_renderer {
         std::unordered_map<std::string_view, transport_catalogue::bus::Bus*> buses_;
         std::set<std::string_view> name_of_buses;
         std::set<transport_catalogue::stop::Stop*, CompStop> all_stops_;
+        std::unordered_map<std::string_view, double> reachable_times_;
+        double max_reachable_time_ = 0;
         svg::Document map_;
         std::string map_as_string_;
 
@@ -139,6 +145,8 @@ namespace map_renderer {
 
         void VisualizationRouteStops(const sphere_projector::SphereProjector& proj);
 
+        svg::Color GetStopColor(std::string_view name) const;
+
         void GetAllStops();
 
         void VisualizationStopName(const sphere_projector::SphereProjector& proj);
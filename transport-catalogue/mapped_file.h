@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace serial_handler {
+
+    // Файл, отображённый в память только для чтения. Страницы читаются с диска при первом обращении
+    // и могут быть вытеснены системой, поэтому занятая память определяется тем, что реально читалось
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::string& path);
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        ~MappedFile();
+
+        const char* GetData() const;
+
+        size_t GetSize() const;
+
+    private:
+        const char* data_ = nullptr;
+        size_t size_ = 0;
+#ifdef _WIN32
+        void* file_ = nullptr;
+        void* mapping_ = nullptr;
+#endif
+    };
+
+}
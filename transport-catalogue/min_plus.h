@@ -0,0 +1,250 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define MIN_PLUS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+// Векторные функции компилируются под свой набор инструкций без общих флагов сборки,
+// а выбираются во время выполнения по возможностям процессора
+#if defined(MIN_PLUS_X86) && (defined(__GNUC__) || defined(__clang__))
+#define MIN_PLUS_TARGET(isa) __attribute__((target(isa)))
+#else
+#define MIN_PLUS_TARGET(isa)
+#endif
+
+namespace graph::min_plus {
+
+    enum class InstructionSet {
+        SCALAR,
+        SSE,
+        AVX2,
+    };
+
+    inline const char* GetInstructionSetName(InstructionSet instruction_set) {
+        switch (instruction_set) {
+            case InstructionSet::SCALAR:
+                return "scalar";
+            case InstructionSet::SSE:
+                return "sse4.1";
+            case InstructionSet::AVX2:
+                return "avx2";
+        }
+        return "";
+    }
+
+    // Лучший набор инструкций, поддерживаемый процессором и операционной системой
+    inline InstructionSet DetectInstructionSet() {
+#if defined(MIN_PLUS_X86) && (defined(__GNUC__) || defined(__clang__))
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return InstructionSet::AVX2;
+        }
+        if (__builtin_cpu_supports("sse4.1")) {
+            return InstructionSet::SSE;
+        }
+#elif defined(MIN_PLUS_X86) && defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+        const bool has_sse41 = (info[2] & (1 << 19)) != 0;
+        const bool has_avx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0
+                             && (_xgetbv(0) & 6) == 6;
+        __cpuidex(info, 7, 0);
+        if (has_avx && (info[1] & (1 << 5)) != 0) {
+            return InstructionSet::AVX2;
+        }
+        if (has_sse41) {
+            return InstructionSet::SSE;
+        }
+#endif
+        return InstructionSet::SCALAR;
+    }
+
+    inline InstructionSet GetInstructionSet() {
+        static const InstructionSet instruction_set = DetectInstructionSet();
+        return instruction_set;
+    }
+
+    // Ячейка строки — вес пути (float, int32_t или uint32_t) и следующее за ним поле prev_edge (uint32_t).
+    // Векторные версии обрабатывают ячейки парами 32-битных полос: чётная полоса — вес, нечётная — ребро
+    template <typename Cell>
+    inline constexpr bool IS_VECTORIZABLE_CELL =
+            std::is_standard_layout_v<Cell>
+            && sizeof(Cell) == 8
+            && sizeof(Cell::weight) == 4
+            && std::is_same_v<decltype(Cell::prev_edge), uint32_t>
+            && (std::is_same_v<decltype(Cell::weight), float>
+                || std::is_same_v<decltype(Cell::weight), int32_t>
+                || std::is_same_v<decltype(Cell::weight), uint32_t>);
+
+    // Обычный цикл с ветвлениями: ячейка row[i] заменяется путём через route_from, если он короче
+    template <typename Cell, typename StoredWeight>
+    void RelaxRowScalar(Cell* row, const Cell* row_through, size_t count, Cell route_from,
+                        StoredWeight no_route, uint32_t no_prev_edge) {
+        for (size_t i = 0; i < count; ++i) {
+            const Cell route_through = row_through[i];
+            if (route_through.weight == no_route) {
+                continue;
+            }
+            const StoredWeight candidate_weight = route_from.weight + route_through.weight;
+            if (candidate_weight < row[i].weight) {
+                row[i].weight = candidate_weight;
+                row[i].prev_edge = route_through.prev_edge != no_prev_edge ? route_through.prev_edge : route_from.prev_edge;
+            }
+        }
+    }
+
+#ifdef MIN_PLUS_X86
+
+    enum class WeightKind {
+        FLOAT,
+        INT32,
+        UINT32,
+    };
+
+    template <typename StoredWeight>
+    constexpr WeightKind GetWeightKind() {
+        if constexpr (std::is_same_v<StoredWeight, float>) {
+            return WeightKind::FLOAT;
+        } else if constexpr (std::is_same_v<StoredWeight, int32_t>) {
+            return WeightKind::INT32;
+        } else {
+            return WeightKind::UINT32;
+        }
+    }
+
+    template <typename StoredWeight>
+    uint32_t GetBits(StoredWeight value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    // Маска полос, в которых a не меньше b, для выбранного типа веса
+    template <WeightKind kind>
+    MIN_PLUS_TARGET("avx2") __m256i NotLessAvx2(__m256i a, __m256i b) {
+        if constexpr (kind == WeightKind::FLOAT) {
+            return _mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _CMP_NLT_UQ));
+        } else if constexpr (kind == WeightKind::INT32) {
+            return _mm256_cmpeq_epi32(_mm256_max_epi32(a, b), a);
+        } else {
+            return _mm256_cmpeq_epi32(_mm256_max_epu32(a, b), a);
+        }
+    }
+
+    template <WeightKind kind>
+    MIN_PLUS_TARGET("avx2") __m256i AddAvx2(__m256i a, __m256i b) {
+        if constexpr (kind == WeightKind::FLOAT) {
+            return _mm256_castps_si256(_mm256_add_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b)));
+        } else {
+            return _mm256_add_epi32(a, b);
+        }
+    }
+
+    // Четыре ячейки за итерацию: вместо ветвлений — маски и смешивание (blend)
+    template <WeightKind kind>
+    MIN_PLUS_TARGET("avx2") void RelaxRowAvx2(void* row, const void* row_through, size_t count,
+                                              uint32_t from_weight, uint32_t from_prev_edge,
+                                              uint32_t no_route, uint32_t no_prev_edge) {
+        auto* row_data = static_cast<__m256i*>(row);
+        const auto* through_data = static_cast<const __m256i*>(row_through);
+        const __m256i from_weights = _mm256_set1_epi32(static_cast<int32_t>(from_weight));
+        const __m256i from_prev_edges = _mm256_set1_epi32(static_cast<int32_t>(from_prev_edge));
+        const __m256i no_routes = _mm256_set1_epi32(static_cast<int32_t>(no_route));
+        const __m256i no_prev_edges = _mm256_set1_epi32(static_cast<int32_t>(no_prev_edge));
+        const __m256i weight_lanes = _mm256_set1_epi64x(0xFFFFFFFFLL);
+        for (size_t i = 0; i < count / 4; ++i) {
+            const __m256i through = _mm256_loadu_si256(through_data + i);
+            const __m256i current = _mm256_loadu_si256(row_data + i);
+            const __m256i candidate_weights = AddAvx2<kind>(through, from_weights);
+            const __m256i prev_edges = _mm256_blendv_epi8(through, from_prev_edges, _mm256_cmpeq_epi32(through, no_prev_edges));
+            const __m256i candidate = _mm256_blend_epi32(candidate_weights, prev_edges, 0b10101010);
+            // Ячейка остаётся прежней, если пути через вершину нет или он не короче
+            __m256i is_kept = _mm256_or_si256(_mm256_cmpeq_epi32(through, no_routes),
+                                              NotLessAvx2<kind>(candidate_weights, current));
+            is_kept = _mm256_and_si256(is_kept, weight_lanes);
+            is_kept = _mm256_or_si256(is_kept, _mm256_slli_epi64(is_kept, 32));
+            _mm256_storeu_si256(row_data + i, _mm256_blendv_epi8(candidate, current, is_kept));
+        }
+    }
+
+    template <WeightKind kind>
+    MIN_PLUS_TARGET("sse4.1") __m128i NotLessSse(__m128i a, __m128i b) {
+        if constexpr (kind == WeightKind::FLOAT) {
+            return _mm_castps_si128(_mm_cmpnlt_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b)));
+        } else if constexpr (kind == WeightKind::INT32) {
+            return _mm_cmpeq_epi32(_mm_max_epi32(a, b), a);
+        } else {
+            return _mm_cmpeq_epi32(_mm_max_epu32(a, b), a);
+        }
+    }
+
+    template <WeightKind kind>
+    MIN_PLUS_TARGET("sse4.1") __m128i AddSse(__m128i a, __m128i b) {
+        if constexpr (kind == WeightKind::FLOAT) {
+            return _mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b)));
+        } else {
+            return _mm_add_epi32(a, b);
+        }
+    }
+
+    // Две ячейки за итерацию, та же схема, что и у RelaxRowAvx2
+    template <WeightKind kind>
+    MIN_PLUS_TARGET("sse4.1") void RelaxRowSse(void* row, const void* row_through, size_t count,
+                                               uint32_t from_weight, uint32_t from_prev_edge,
+                                               uint32_t no_route, uint32_t no_prev_edge) {
+        auto* row_data = static_cast<__m128i*>(row);
+        const auto* through_data = static_cast<const __m128i*>(row_through);
+        const __m128i from_weights = _mm_set1_epi32(static_cast<int32_t>(from_weight));
+        const __m128i from_prev_edges = _mm_set1_epi32(static_cast<int32_t>(from_prev_edge));
+        const __m128i no_routes = _mm_set1_epi32(static_cast<int32_t>(no_route));
+        const __m128i no_prev_edges = _mm_set1_epi32(static_cast<int32_t>(no_prev_edge));
+        const __m128i weight_lanes = _mm_set1_epi64x(0xFFFFFFFFLL);
+        for (size_t i = 0; i < count / 2; ++i) {
+            const __m128i through = _mm_loadu_si128(through_data + i);
+            const __m128i current = _mm_loadu_si128(row_data + i);
+            const __m128i candidate_weights = AddSse<kind>(through, from_weights);
+            const __m128i prev_edges = _mm_blendv_epi8(through, from_prev_edges, _mm_cmpeq_epi32(through, no_prev_edges));
+            const __m128i candidate = _mm_blend_epi16(candidate_weights, prev_edges, 0b11001100);
+            __m128i is_kept = _mm_or_si128(_mm_cmpeq_epi32(through, no_routes),
+                                           NotLessSse<kind>(candidate_weights, current));
+            is_kept = _mm_and_si128(is_kept, weight_lanes);
+            is_kept = _mm_or_si128(is_kept, _mm_slli_epi64(is_kept, 32));
+            _mm_storeu_si128(row_data + i, _mm_blendv_epi8(candidate, current, is_kept));
+        }
+    }
+
+#endif
+
+    // Релаксация строки row через вершину, путь до которой — route_from, а строка путей из неё — row_through.
+    // Результат не зависит от набора инструкций: векторные версии складывают веса в том же порядке
+    template <typename Cell, typename StoredWeight>
+    void RelaxRow(Cell* row, const Cell* row_through, size_t count, Cell route_from,
+                  StoredWeight no_route, uint32_t no_prev_edge, InstructionSet instruction_set = GetInstructionSet()) {
+        size_t done = 0;
+#ifdef MIN_PLUS_X86
+        if constexpr (IS_VECTORIZABLE_CELL<Cell>) {
+            constexpr WeightKind kind = GetWeightKind<StoredWeight>();
+            const uint32_t from_weight = GetBits(route_from.weight);
+            const uint32_t no_route_bits = GetBits(no_route);
+            if (instruction_set == InstructionSet::AVX2) {
+                RelaxRowAvx2<kind>(row, row_through, count, from_weight, route_from.prev_edge, no_route_bits, no_prev_edge);
+                done = count / 4 * 4;
+            } else if (instruction_set == InstructionSet::SSE) {
+                RelaxRowSse<kind>(row, row_through, count, from_weight, route_from.prev_edge, no_route_bits, no_prev_edge);
+                done = count / 2 * 2;
+            }
+        }
+#endif
+        RelaxRowScalar(row + done, row_through + done, count - done, route_from, no_route, no_prev_edge);
+    }
+
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace parallel {
+
+    inline size_t GetThreadCount() {
+        return std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    // Вызывает func(index) для каждого index из [0, count), раздавая индексы потокам по одному
+    template <typename Func>
+    void ParallelFor(size_t count, size_t thread_count, Func func) {
+        thread_count = std::min(thread_count, count);
+        if (thread_count <= 1) {
+            for (size_t index = 0; index < count; ++index) {
+                func(index);
+            }
+            return;
+        }
+
+        std::atomic<size_t> next_index = 0;
+        auto worker = [&]() {
+            for (size_t index = next_index++; index < count; index = next_index++) {
+                func(index);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(thread_count - 1);
+        for (size_t i = 1; i < thread_count; ++i) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+}
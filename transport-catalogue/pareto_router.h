@@ -0,0 +1,116 @@
+#pragma once
+
+#include "graph.h"
+#include "router_engine.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+    // Многокритериальный поиск с закреплением меток (label-setting) по двум критериям:
+    // суммарному весу и числу посадок — пройденных рёбер, отмеченных в boarding_edges.
+    // Метки извлекаются из очереди в лексикографическом порядке (вес, посадки), поэтому новая метка
+    // вершины доминируется закреплёнными ранее тогда и только тогда, когда посадок у неё не меньше,
+    // чем у последней из них. Для каждой вершины хватает одного числа — наименьшего числа посадок
+    template <typename Weight>
+    class ParetoRouter {
+    private:
+        using Graph = DirectedWeightedGraph<Weight>;
+
+    public:
+        ParetoRouter(const Graph& graph, std::vector<bool>&& boarding_edges);
+
+        // Парето-множество маршрутов по возрастанию веса; число посадок при этом строго убывает
+        std::vector<RouteInfo<Weight>> BuildRoutes(VertexId from, VertexId to) const;
+
+    private:
+        struct Label {
+            VertexId vertex;
+            Weight weight;
+            size_t boarding_count;
+            std::optional<EdgeId> edge;
+            size_t parent;
+        };
+
+        using QueueItem = std::tuple<Weight, size_t, size_t>;
+
+        static constexpr Weight ZERO_WEIGHT{};
+        static constexpr size_t NONE = std::numeric_limits<size_t>::max();
+        const Graph& graph_;
+        std::vector<bool> boarding_edges_;
+    };
+
+    template <typename Weight>
+    ParetoRouter<Weight>::ParetoRouter(const Graph& graph, std::vector<bool>&& boarding_edges)
+            : graph_(graph)
+            , boarding_edges_(std::move(boarding_edges)) {
+        if (boarding_edges_.size() != graph_.GetEdgeCount()) {
+            throw std::invalid_argument("Boarding edges don't match graph edges");
+        }
+        for (const auto& edge : graph_.GetEdges()) {
+            if (edge.weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+        }
+    }
+
+    template <typename Weight>
+    std::vector<RouteInfo<Weight>> ParetoRouter<Weight>::BuildRoutes(VertexId from, VertexId to) const {
+        const size_t vertex_count = graph_.GetVertexCount();
+        if (from >= vertex_count || to >= vertex_count) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+
+        std::vector<Label> labels{{from, ZERO_WEIGHT, 0, std::nullopt, NONE}};
+        std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+        queue.push({ZERO_WEIGHT, 0, 0});
+        // Наименьшее число посадок среди закреплённых меток вершины
+        std::vector<size_t> min_boarding_counts(vertex_count, NONE);
+        std::vector<size_t> target_labels;
+
+        while (!queue.empty()) {
+            const auto [weight, boarding_count, label_id] = queue.top();
+            queue.pop();
+            const VertexId vertex = labels[label_id].vertex;
+            // Метку доминирует закреплённая метка этой вершины или уже найденный маршрут до цели
+            if (boarding_count >= min_boarding_counts[vertex] || boarding_count >= min_boarding_counts[to]) {
+                continue;
+            }
+            min_boarding_counts[vertex] = boarding_count;
+            if (vertex == to) {
+                target_labels.push_back(label_id);
+                continue;
+            }
+            for (const auto& edge : graph_.GetIncidentEdges(vertex)) {
+                const size_t candidate_boarding_count = boarding_count + (boarding_edges_[edge.id] ? 1 : 0);
+                if (candidate_boarding_count >= min_boarding_counts[edge.to]
+                    || candidate_boarding_count >= min_boarding_counts[to]) {
+                    continue;
+                }
+                labels.push_back({edge.to, weight + edge.weight, candidate_boarding_count, edge.id, label_id});
+                queue.push({labels.back().weight, candidate_boarding_count, labels.size() - 1});
+            }
+        }
+
+        std::vector<RouteInfo<Weight>> routes;
+        routes.reserve(target_labels.size());
+        for (const size_t target_label : target_labels) {
+            std::vector<EdgeId> edges;
+            for (size_t label_id = target_label; labels[label_id].edge; label_id = labels[label_id].parent) {
+                edges.push_back(*labels[label_id].edge);
+            }
+            std::reverse(edges.begin(), edges.end());
+            routes.push_back({labels[target_label].weight, std::move(edges)});
+        }
+        return routes;
+    }
+
+}
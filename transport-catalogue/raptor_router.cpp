@@ -0,0 +1,168 @@
+#include "raptor_router.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace transport_router {
+
+    RaptorRouter::RaptorRouter(std::vector<Line>&& lines, std::vector<std::string_view>&& stop_names,
+                               double bus_wait_time, double bus_velocity)
+            : lines_(std::move(lines))
+            , stop_names_(std::move(stop_names))
+            , stop_to_lines_(stop_names_.size())
+            , settings_{bus_wait_time, bus_velocity} {
+        for (size_t line = 0; line < lines_.size(); ++line) {
+            if (lines_[line].stops.size() != lines_[line].distances.size()) {
+                throw std::invalid_argument("Line stops don't match line distances");
+            }
+            for (size_t position = 0; position < lines_[line].stops.size(); ++position) {
+                stop_to_lines_.at(lines_[line].stops[position]).push_back({line, position});
+            }
+        }
+    }
+
+    double RaptorRouter::GetRideTime(const Line& line, size_t board_position, size_t alight_position, const Settings& settings) const {
+        const double distance = line.distances[alight_position] - line.distances[board_position];
+        return distance / 1000.0 / settings.bus_velocity * 60;
+    }
+
+    std::optional<RouteInfo> RaptorRouter::BuildRoute(graph::VertexId from, graph::VertexId to) const {
+        return BuildRoute(from, to, settings_);
+    }
+
+    std::optional<RouteInfo> RaptorRouter::BuildRoute(graph::VertexId from, graph::VertexId to, const Settings& settings) const {
+        const size_t stop_count = stop_names_.size();
+        if (from >= stop_count || to >= stop_count) {
+            throw std::out_of_range("Stop id is out of range");
+        }
+        if (from == to) {
+            return RouteInfo{};
+        }
+        const std::vector<std::vector<Label>> stop_labels = RunRounds(from, to, std::nullopt, settings).stop_labels;
+        if (stop_labels[to].empty()) {
+            return std::nullopt;
+        }
+        return BuildRouteInfo(stop_labels, from, to, stop_labels[to].back().round, settings);
+    }
+
+    std::vector<RouteInfo> RaptorRouter::BuildParetoRoutes(graph::VertexId from, graph::VertexId to) const {
+        const size_t stop_count = stop_names_.size();
+        if (from >= stop_count || to >= stop_count) {
+            throw std::out_of_range("Stop id is out of range");
+        }
+        if (from == to) {
+            return {RouteInfo{}};
+        }
+        const std::vector<std::vector<Label>> stop_labels = RunRounds(from, to, std::nullopt, settings_).stop_labels;
+        std::vector<RouteInfo> routes;
+        for (auto label_it = stop_labels[to].rbegin(); label_it != stop_labels[to].rend(); ++label_it) {
+            routes.push_back(BuildRouteInfo(stop_labels, from, to, label_it->round, settings_));
+        }
+        return routes;
+    }
+
+    std::vector<std::optional<double>> RaptorRouter::BuildArrivalTimes(graph::VertexId from, std::optional<double> max_time) const {
+        if (from >= stop_names_.size()) {
+            throw std::out_of_range("Stop id is out of range");
+        }
+        return RunRounds(from, std::nullopt, max_time, settings_).best_times;
+    }
+
+    RaptorRouter::Rounds RaptorRouter::RunRounds(graph::VertexId from, std::optional<graph::VertexId> to,
+                                                 std::optional<double> max_time, const Settings& settings) const {
+        const size_t stop_count = stop_names_.size();
+        std::vector<std::optional<double>> best_times(stop_count);
+        best_times[from] = 0;
+        // Времена прибытия не более чем с k - 1 и с k посадками
+        std::vector<std::optional<double>> previous_times = best_times;
+        std::vector<std::optional<double>> times = best_times;
+        std::vector<std::vector<Label>> stop_labels(stop_count);
+        std::vector<bool> is_marked(stop_count, false);
+        std::vector<graph::VertexId> marked_stops{from};
+
+        for (size_t round = 1; !marked_stops.empty(); ++round) {
+            // Каждый маршрут сканируется с самой ранней остановки, улучшенной в прошлом раунде
+            std::vector<std::optional<size_t>> line_starts(lines_.size());
+            for (const graph::VertexId stop : marked_stops) {
+                for (const auto& [line, position] : stop_to_lines_[stop]) {
+                    if (!line_starts[line] || position < *line_starts[line]) {
+                        line_starts[line] = position;
+                    }
+                }
+            }
+
+            for (const graph::VertexId stop : marked_stops) {
+                previous_times[stop] = times[stop];
+                is_marked[stop] = false;
+            }
+            marked_stops.clear();
+
+            for (size_t line_id = 0; line_id < lines_.size(); ++line_id) {
+                if (!line_starts[line_id]) {
+                    continue;
+                }
+                const Line& line = lines_[line_id];
+                std::optional<size_t> board_position;
+                double board_time = 0;
+                for (size_t position = *line_starts[line_id]; position < line.stops.size(); ++position) {
+                    const graph::VertexId stop = line.stops[position];
+                    std::optional<double> arrival_time;
+                    if (board_position) {
+                        arrival_time = board_time + GetRideTime(line, *board_position, position, settings);
+                        const bool is_better = (!best_times[stop] || *arrival_time < *best_times[stop])
+                                               && (!to || !best_times[*to] || *arrival_time < *best_times[*to])
+                                               && (!max_time || *arrival_time <= *max_time);
+                        if (is_better) {
+                            best_times[stop] = arrival_time;
+                            times[stop] = arrival_time;
+                            if (stop_labels[stop].empty() || stop_labels[stop].back().round != round) {
+                                stop_labels[stop].emplace_back();
+                            }
+                            stop_labels[stop].back() = Label{round, line_id, *board_position, position};
+                            if (!is_marked[stop]) {
+                                is_marked[stop] = true;
+                                marked_stops.push_back(stop);
+                            }
+                        }
+                    }
+                    if (previous_times[stop]) {
+                        const double candidate_board_time = *previous_times[stop] + settings.bus_wait_time;
+                        if (!arrival_time || candidate_board_time < *arrival_time) {
+                            board_position = position;
+                            board_time = candidate_board_time;
+                        }
+                    }
+                }
+            }
+        }
+
+        return {std::move(best_times), std::move(stop_labels)};
+    }
+
+    // Маршрут восстанавливается от to назад: каждая поездка начинается на остановке,
+    // время прибытия в которую улучшилось в одном из предыдущих раундов
+    RouteInfo RaptorRouter::BuildRouteInfo(const std::vector<std::vector<Label>>& stop_labels, graph::VertexId from,
+                                           graph::VertexId to, size_t round, const Settings& settings) const {
+        RouteInfo result;
+        graph::VertexId stop = to;
+        while (stop != from) {
+            auto label_it = std::find_if(stop_labels[stop].rbegin(), stop_labels[stop].rend(), [round](const Label& label) {
+                return label.round <= round;
+            });
+            const Label& label = *label_it;
+            const Line& line = lines_[label.line];
+            result.edges.push_back(BusEdgeInfo{line.bus_name, label.alight_position - label.board_position,
+                                               GetRideTime(line, label.board_position, label.alight_position, settings)});
+            result.edges.push_back(WaitEdgeInfo{stop_names_[line.stops[label.board_position]], settings.bus_wait_time});
+            stop = line.stops[label.board_position];
+            round = label.round - 1;
+        }
+        std::reverse(result.edges.begin(), result.edges.end());
+
+        for (const auto& edge : result.edges) {
+            result.total_time += std::visit([](const auto& info) { return info.time; }, edge);
+        }
+        return result;
+    }
+
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "domain.h"
+#include "graph.h"
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace transport_router {
+
+    // Поиск по раундам (в духе RAPTOR) прямо по последовательностям остановок автобусов:
+    // раунд k находит лучшие времена прибытия не более чем с k посадками.
+    // Остановки адресуются номером вершины bus_wait_begin, как и в графе TransportRouter
+    class RaptorRouter {
+    public:
+        // Направление движения автобуса: остановки и накопленное от первой из них расстояние
+        struct Line {
+            std::string_view bus_name;
+            std::vector<graph::VertexId> stops;
+            std::vector<uint64_t> distances;
+        };
+
+        // Время ожидания в минутах и скорость в км/ч, по которым считаются времена в пути
+        struct Settings {
+            double bus_wait_time = 0;
+            double bus_velocity = 0;
+        };
+
+        RaptorRouter(std::vector<Line>&& lines, std::vector<std::string_view>&& stop_names,
+                     double bus_wait_time, double bus_velocity);
+
+        std::optional<RouteInfo> BuildRoute(graph::VertexId from, graph::VertexId to) const;
+
+        // Маршрут по настройкам запроса вместо заданных при построении
+        std::optional<RouteInfo> BuildRoute(graph::VertexId from, graph::VertexId to, const Settings& settings) const;
+
+        // Раунд, в котором улучшилось время прибытия в to, даёт маршрут, лучший по времени среди
+        // маршрутов с не большим числом посадок. Результат — по возрастанию времени в пути
+        std::vector<RouteInfo> BuildParetoRoutes(graph::VertexId from, graph::VertexId to) const;
+
+        // Лучшие времена прибытия на остановки, достижимые не дольше чем за max_time или вовсе без ограничения
+        std::vector<std::optional<double>> BuildArrivalTimes(graph::VertexId from, std::optional<double> max_time) const;
+
+    private:
+        struct LinePosition {
+            size_t line;
+            size_t position;
+        };
+
+        struct Label {
+            size_t round = 0;
+            size_t line = 0;
+            size_t board_position = 0;
+            size_t alight_position = 0;
+        };
+
+        double GetRideTime(const Line& line, size_t board_position, size_t alight_position, const Settings& settings) const;
+
+        struct Rounds {
+            std::vector<std::optional<double>> best_times;
+            // Для каждой остановки — метки в порядке возрастания раунда, в котором она улучшалась
+            std::vector<std::vector<Label>> stop_labels;
+        };
+
+        // Времена прибытия, не улучшающие уже найденное время до to или превышающие max_time, отбрасываются
+        Rounds RunRounds(graph::VertexId from, std::optional<graph::VertexId> to, std::optional<double> max_time,
+                         const Settings& settings) const;
+
+        RouteInfo BuildRouteInfo(const std::vector<std::vector<Label>>& stop_labels, graph::VertexId from,
+                                 graph::VertexId to, size_t round, const Settings& settings) const;
+
+        std::vector<Line> lines_;
+        std::vector<std::string_view> stop_names_;
+        std::vector<std::vector<LinePosition>> stop_to_lines_;
+        Settings settings_;
+    };
+
+}
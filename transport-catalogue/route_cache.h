@@ -0,0 +1,82 @@
+#pragma once
+
+#include "domain.h"
+#include "graph.h"
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+namespace transport_router {
+
+    // Ограниченный кэш готовых маршрутов с вытеснением давно не запрашивавшихся (LRU).
+    // Отсутствие маршрута тоже кэшируется. Все методы потокобезопасны
+    class RouteCache {
+    public:
+        struct Stats {
+            size_t hits = 0;
+            size_t misses = 0;
+        };
+
+        explicit RouteCache(size_t capacity) : capacity_(capacity) {
+        }
+
+        // Пустой внешний optional — промах, пустой внутренний — маршрута нет
+        std::optional<std::optional<RouteInfo>> Find(graph::VertexId from, graph::VertexId to) {
+            std::lock_guard guard(mutex_);
+            const auto it = items_.find({from, to});
+            if (it == items_.end()) {
+                ++stats_.misses;
+                return std::nullopt;
+            }
+            ++stats_.hits;
+            order_.splice(order_.begin(), order_, it->second);
+            return it->second->second;
+        }
+
+        void Insert(graph::VertexId from, graph::VertexId to, const std::optional<RouteInfo>& route_info) {
+            if (capacity_ == 0) {
+                return;
+            }
+            std::lock_guard guard(mutex_);
+            const Key key{from, to};
+            if (const auto it = items_.find(key); it != items_.end()) {
+                it->second->second = route_info;
+                order_.splice(order_.begin(), order_, it->second);
+                return;
+            }
+            if (items_.size() == capacity_) {
+                items_.erase(order_.back().first);
+                order_.pop_back();
+            }
+            order_.emplace_front(key, route_info);
+            items_[key] = order_.begin();
+        }
+
+        Stats GetStats() const {
+            std::lock_guard guard(mutex_);
+            return stats_;
+        }
+
+    private:
+        using Key = std::pair<graph::VertexId, graph::VertexId>;
+
+        struct KeyHash {
+            size_t operator()(const Key& key) const noexcept {
+                return std::hash<uint64_t>{}(static_cast<uint64_t>(key.first) * 0x9E3779B97F4A7C15ULL ^ key.second);
+            }
+        };
+
+        using Order = std::list<std::pair<Key, std::optional<RouteInfo>>>;
+
+        size_t capacity_;
+        mutable std::mutex mutex_;
+        Order order_;
+        std::unordered_map<Key, Order::iterator, KeyHash> items_;
+        Stats stats_;
+    };
+
+}
@@ -1,13 +1,22 @@
 #pragma once
 
 #include "graph.h"
+#include "min_plus.h"
+#include "router_engine.h"
+#include "parallel.h"
 
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <iterator>
+#include <limits>
+#include <functional>
+#include <memory>
 #include <optional>
+#include <queue>
+#include <span>
 #include <stdexcept>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -15,7 +24,7 @@
 namespace graph {
 
     template <typename Weight>
-    class Router {
+    class Router : public RouterEngine<Weight> {
     private:
         using Graph = DirectedWeightedGraph<Weight>;
 
@@ -23,61 +32,212 @@ namespace graph {
 
         explicit Router(const Graph& graph);
 
-        struct RouteInfo {
-            Weight weight;
-            std::vector<EdgeId> edges;
+        // Параметры блочного (tiled) построения таблицы: плитки каждой фазы считаются параллельно
+        struct BlockedBuild {
+            size_t block_size = 64;
+            size_t thread_count = parallel::GetThreadCount();
         };
+
+        Router(const Graph& graph, BlockedBuild build);
+
+        using RouteInfo = graph::RouteInfo<Weight>;
+
+        // Вещественные веса хранятся в таблице как float: он нужен только для сравнения маршрутов,
+        // итоговый вес в BuildRoute пересчитывается по рёбрам в исходном типе Weight
+        using StoredWeight = std::conditional_t<std::is_floating_point_v<Weight>, float, Weight>;
+
+        static constexpr StoredWeight NO_ROUTE = std::numeric_limits<StoredWeight>::max();
+        static constexpr uint32_t NO_PREV_EDGE = std::numeric_limits<uint32_t>::max();
+
         struct RouteInternalData {
-            Weight weight;
-            std::optional<EdgeId> prev_edge;
+            StoredWeight weight = NO_ROUTE;
+            uint32_t prev_edge = NO_PREV_EDGE;
+
+            bool HasRoute() const {
+                return weight != NO_ROUTE;
+            }
+            bool HasPrevEdge() const {
+                return prev_edge != NO_PREV_EDGE;
+            }
+        };
+
+        // Плоская матрица vertex_count x vertex_count, хранящаяся по строкам в одном буфере.
+        // Буфер принадлежит матрице либо только читается из чужой памяти, например из отображённого
+        // в память файла базы: тогда строки подгружаются с диска при первом обращении к ним
+        class RoutesInternalData {
+        public:
+            RoutesInternalData() = default;
+
+            explicit RoutesInternalData(size_t vertex_count)
+                    : vertex_count_(vertex_count)
+                    , cells_(vertex_count * vertex_count) {
+            }
+
+            RoutesInternalData(size_t vertex_count, std::vector<RouteInternalData>&& cells)
+                    : vertex_count_(vertex_count)
+                    , cells_(std::move(cells)) {
+                if (cells_.size() != vertex_count_ * vertex_count_) {
+                    throw std::invalid_argument("Routes matrix size doesn't match vertex count");
+                }
+            }
+
+            // shared_cells указывает на vertex_count * vertex_count ячеек и владеет памятью под ними
+            RoutesInternalData(size_t vertex_count, std::shared_ptr<const RouteInternalData> shared_cells)
+                    : vertex_count_(vertex_count)
+                    , shared_cells_(std::move(shared_cells)) {
+            }
+
+            size_t GetVertexCount() const {
+                return vertex_count_;
+            }
+
+            // Изменять можно только собственный буфер, см. Materialize
+            RouteInternalData* operator[](VertexId from) {
+                assert(!shared_cells_);
+                return cells_.data() + from * vertex_count_;
+            }
+
+            const RouteInternalData* operator[](VertexId from) const {
+                return GetData() + from * vertex_count_;
+            }
+
+            const RouteInternalData& At(VertexId from, VertexId to) const {
+                if (from >= vertex_count_ || to >= vertex_count_) {
+                    throw std::out_of_range("Vertex id is out of range");
+                }
+                return (*this)[from][to];
+            }
+
+            std::span<const RouteInternalData> GetCells() const {
+                return {GetData(), vertex_count_ * vertex_count_};
+            }
+
+            // Копирует чужой буфер в собственный перед изменением таблицы
+            void Materialize() {
+                if (shared_cells_) {
+                    cells_.assign(shared_cells_.get(), shared_cells_.get() + vertex_count_ * vertex_count_);
+                    shared_cells_.reset();
+                }
+            }
+
+        private:
+            const RouteInternalData* GetData() const {
+                return shared_cells_ ? shared_cells_.get() : cells_.data();
+            }
+
+            size_t vertex_count_ = 0;
+            std::vector<RouteInternalData> cells_;
+            std::shared_ptr<const RouteInternalData> shared_cells_;
         };
 
-        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
-        using RoutesInternalData = std::vector<std::vector<std::optional<RouteInternalData>>>;
+        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
 
         Router(const Graph& graph, RoutesInternalData&& routes_internal_data);
         const RoutesInternalData& GetRoutesInternalData() const;
 
+        // Доводит таблицу до уже изменённого и замороженного графа. Строки, дерево путей которых
+        // проходит через потяжелевшее ребро, пересчитываются алгоритмом Дейкстры; вставленные
+        // и полегчавшие рёбра учитываются через кратчайшие пути между их концами
+        void Update(const std::vector<EdgeUpdate<Weight>>& updates, size_t thread_count = parallel::GetThreadCount());
+
     private:
+        void ResizeRoutesInternalData(size_t vertex_count);
+
+        void RecomputeRow(VertexId from);
+
+        void RelaxRoutesThroughEdges(const std::vector<EdgeId>& edge_ids, size_t thread_count);
+
         void InitializeRoutesInternalData(const Graph& graph) {
             const size_t vertex_count = graph.GetVertexCount();
             for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
-                routes_internal_data_[vertex][vertex] = RouteInternalData{ZERO_WEIGHT, std::nullopt};
-                for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
-                    const auto& edge = graph.GetEdge(edge_id);
+                routes_internal_data_[vertex][vertex] = RouteInternalData{StoredWeight{}, NO_PREV_EDGE};
+                for (const auto& edge : graph.GetIncidentEdges(vertex)) {
                     if (edge.weight < ZERO_WEIGHT) {
                         throw std::domain_error("Edges' weights should be non-negative");
                     }
+                    if (edge.id >= NO_PREV_EDGE) {
+                        throw std::length_error("Too many edges for the routes matrix");
+                    }
                     auto& route_internal_data = routes_internal_data_[vertex][edge.to];
-                    if (!route_internal_data || route_internal_data->weight > edge.weight) {
-                        route_internal_data = RouteInternalData{edge.weight, edge_id};
+                    const auto weight = static_cast<StoredWeight>(edge.weight);
+                    if (route_internal_data.weight > weight) {
+                        route_internal_data = RouteInternalData{weight, static_cast<uint32_t>(edge.id)};
                     }
                 }
             }
         }
 
-        void RelaxRoute(VertexId vertex_from, VertexId vertex_to, const RouteInternalData& route_from,
-                        const RouteInternalData& route_to) {
-            auto& route_relaxing = routes_internal_data_[vertex_from][vertex_to];
-            const Weight candidate_weight = route_from.weight + route_to.weight;
-            if (!route_relaxing || candidate_weight < route_relaxing->weight) {
-                route_relaxing = {candidate_weight,
-                                  route_to.prev_edge ? route_to.prev_edge : route_from.prev_edge};
+        // Строка путей row улучшается путями через вершину: route_from — путь до неё, row_through — пути из неё
+        static void RelaxRow(RouteInternalData* row, const RouteInternalData* row_through, size_t count,
+                             const RouteInternalData& route_from) {
+            min_plus::RelaxRow(row, row_through, count, route_from, NO_ROUTE, NO_PREV_EDGE);
+        }
+
+        void RelaxRowThroughVertex(VertexId vertex_from, VertexId vertex_through, VertexId to_begin, VertexId to_end) {
+            RouteInternalData* row_from = routes_internal_data_[vertex_from];
+            const RouteInternalData route_from = row_from[vertex_through];
+            if (!route_from.HasRoute()) {
+                return;
             }
+            const RouteInternalData* row_through = routes_internal_data_[vertex_through];
+            RelaxRow(row_from + to_begin, row_through + to_begin, to_end - to_begin, route_from);
         }
 
         void RelaxRoutesInternalDataThroughVertex(size_t vertex_count, VertexId vertex_through) {
             for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
-                if (const auto& route_from = routes_internal_data_[vertex_from][vertex_through]) {
-                    for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
-                        if (const auto& route_to = routes_internal_data_[vertex_through][vertex_to]) {
-                            RelaxRoute(vertex_from, vertex_to, *route_from, *route_to);
-                        }
-                    }
+                RelaxRowThroughVertex(vertex_from, vertex_through, 0, vertex_count);
+            }
+        }
+
+        struct Block {
+            VertexId begin;
+            VertexId end;
+        };
+
+        void RelaxBlockThroughBlock(const Block& block_from, const Block& block_to, const Block& block_through) {
+            for (VertexId vertex_through = block_through.begin; vertex_through < block_through.end; ++vertex_through) {
+                for (VertexId vertex_from = block_from.begin; vertex_from < block_from.end; ++vertex_from) {
+                    RelaxRowThroughVertex(vertex_from, vertex_through, block_to.begin, block_to.end);
                 }
             }
         }
 
+        // Фаза 1 обрабатывает диагональную плитку, фаза 2 — её строку и столбец,
+        // фаза 3 — все остальные плитки. Внутри фаз 2 и 3 плитки независимы
+        void RelaxRoutesInternalDataBlocked(size_t vertex_count, const BlockedBuild& build) {
+            const size_t block_size = std::max<size_t>(1, build.block_size);
+            const size_t block_count = (vertex_count + block_size - 1) / block_size;
+            auto get_block = [&](size_t index) {
+                return Block{index * block_size, std::min(vertex_count, (index + 1) * block_size)};
+            };
+
+            for (size_t through = 0; through < block_count; ++through) {
+                const Block block_through = get_block(through);
+                RelaxBlockThroughBlock(block_through, block_through, block_through);
+
+                parallel::ParallelFor(2 * block_count, build.thread_count, [&](size_t index) {
+                    const size_t other = index / 2;
+                    if (other == through) {
+                        return;
+                    }
+                    if (index % 2 == 0) {
+                        RelaxBlockThroughBlock(block_through, get_block(other), block_through);
+                    } else {
+                        RelaxBlockThroughBlock(get_block(other), block_through, block_through);
+                    }
+                });
+
+                parallel::ParallelFor(block_count * block_count, build.thread_count, [&](size_t index) {
+                    const size_t from = index / block_count;
+                    const size_t to = index % block_count;
+                    if (from == through || to == through) {
+                        return;
+                    }
+                    RelaxBlockThroughBlock(get_block(from), get_block(to), block_through);
+                });
+            }
+        }
+
         static constexpr Weight ZERO_WEIGHT{};
         const Graph& graph_;
         RoutesInternalData routes_internal_data_;
@@ -86,8 +246,7 @@ namespace graph {
     template <typename Weight>
     Router<Weight>::Router(const Graph& graph)
             : graph_(graph)
-            , routes_internal_data_(graph.GetVertexCount(),
-                                    std::vector<std::optional<RouteInternalData>>(graph.GetVertexCount()))
+            , routes_internal_data_(graph.GetVertexCount())
     {
         InitializeRoutesInternalData(graph);
 
@@ -97,23 +256,37 @@ namespace graph {
         }
     }
 
+    template <typename Weight>
+    Router<Weight>::Router(const Graph& graph, BlockedBuild build)
+            : graph_(graph)
+            , routes_internal_data_(graph.GetVertexCount())
+    {
+        InitializeRoutesInternalData(graph);
+        RelaxRoutesInternalDataBlocked(graph.GetVertexCount(), build);
+    }
+
     template <typename Weight>
     std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
                                                                                  VertexId to) const {
-        const auto& route_internal_data = routes_internal_data_.at(from).at(to);
-        if (!route_internal_data) {
+        const auto& route_internal_data = routes_internal_data_.At(from, to);
+        if (!route_internal_data.HasRoute()) {
             return std::nullopt;
         }
-        const Weight weight = route_internal_data->weight;
+        const RouteInternalData* row_from = routes_internal_data_[from];
         std::vector<EdgeId> edges;
-        for (std::optional<EdgeId> edge_id = route_internal_data->prev_edge;
-             edge_id;
-             edge_id = routes_internal_data_[from][graph_.GetEdge(*edge_id).from]->prev_edge)
+        for (uint32_t edge_id = route_internal_data.prev_edge;
+             edge_id != NO_PREV_EDGE;
+             edge_id = row_from[graph_.GetEdge(edge_id).from].prev_edge)
         {
-            edges.push_back(*edge_id);
+            edges.push_back(edge_id);
         }
         std::reverse(edges.begin(), edges.end());
 
+        Weight weight = ZERO_WEIGHT;
+        for (const EdgeId edge_id : edges) {
+            weight += graph_.GetEdge(edge_id).weight;
+        }
+
         return RouteInfo{weight, std::move(edges)};
     }
 
@@ -123,6 +296,164 @@ namespace graph {
     }
 
     template <typename Weight>
-    Router<Weight>::Router(const Graph& graph, RoutesInternalData&& routes_internal_data) : graph_(graph), routes_internal_data_(move(routes_internal_data))  { }
+    Router<Weight>::Router(const Graph& graph, RoutesInternalData&& routes_internal_data) : graph_(graph), routes_internal_data_(std::move(routes_internal_data))  { }
+
+    template <typename Weight>
+    void Router<Weight>::Update(const std::vector<EdgeUpdate<Weight>>& updates, size_t thread_count) {
+        routes_internal_data_.Materialize();
+        if (graph_.GetVertexCount() > routes_internal_data_.GetVertexCount()) {
+            ResizeRoutesInternalData(graph_.GetVertexCount());
+        }
+        const size_t vertex_count = routes_internal_data_.GetVertexCount();
+
+        std::vector<bool> is_row_affected(vertex_count, false);
+        std::vector<EdgeId> lighter_edges;
+        for (const auto& update : updates) {
+            const Edge<Weight>& edge = graph_.GetEdge(update.id);
+            if (edge.weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+            if (update.id >= NO_PREV_EDGE) {
+                throw std::length_error("Too many edges for the routes matrix");
+            }
+            if (!update.old_weight || edge.weight < *update.old_weight) {
+                lighter_edges.push_back(update.id);
+            } else if (*update.old_weight < edge.weight) {
+                // Ребро входит в дерево путей строки, только если ведёт в свой конец
+                for (VertexId from = 0; from < vertex_count; ++from) {
+                    if (routes_internal_data_[from][edge.to].prev_edge == update.id) {
+                        is_row_affected[from] = true;
+                    }
+                }
+            }
+        }
+
+        parallel::ParallelFor(vertex_count, thread_count, [&](size_t from) {
+            if (is_row_affected[from]) {
+                RecomputeRow(from);
+            }
+        });
+        if (!lighter_edges.empty()) {
+            RelaxRoutesThroughEdges(lighter_edges, thread_count);
+        }
+    }
+
+    template <typename Weight>
+    void Router<Weight>::ResizeRoutesInternalData(size_t vertex_count) {
+        const size_t old_vertex_count = routes_internal_data_.GetVertexCount();
+        RoutesInternalData routes_internal_data(vertex_count);
+        for (VertexId from = 0; from < old_vertex_count; ++from) {
+            std::copy(routes_internal_data_[from], routes_internal_data_[from] + old_vertex_count,
+                      routes_internal_data[from]);
+        }
+        for (VertexId vertex = old_vertex_count; vertex < vertex_count; ++vertex) {
+            routes_internal_data[vertex][vertex] = RouteInternalData{StoredWeight{}, NO_PREV_EDGE};
+        }
+        routes_internal_data_ = std::move(routes_internal_data);
+    }
+
+    template <typename Weight>
+    void Router<Weight>::RecomputeRow(VertexId from) {
+        using QueueItem = std::pair<Weight, VertexId>;
+        const size_t vertex_count = routes_internal_data_.GetVertexCount();
+        std::vector<std::optional<Weight>> weights(vertex_count);
+        std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+        RouteInternalData* row = routes_internal_data_[from];
+        std::fill(row, row + vertex_count, RouteInternalData{});
+
+        weights[from] = ZERO_WEIGHT;
+        row[from] = RouteInternalData{StoredWeight{}, NO_PREV_EDGE};
+        queue.push({ZERO_WEIGHT, from});
+        while (!queue.empty()) {
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+            if (weight > *weights[vertex]) {
+                continue;
+            }
+            for (const auto& edge : graph_.GetIncidentEdges(vertex)) {
+                const Weight candidate_weight = weight + edge.weight;
+                if (!weights[edge.to] || candidate_weight < *weights[edge.to]) {
+                    weights[edge.to] = candidate_weight;
+                    row[edge.to] = RouteInternalData{static_cast<StoredWeight>(candidate_weight),
+                                                     static_cast<uint32_t>(edge.id)};
+                    queue.push({candidate_weight, edge.to});
+                }
+            }
+        }
+    }
+
+    // Новый кратчайший путь через изменённые рёбра имеет вид: старый путь до начала первого
+    // из них, путь между концами изменённых рёбер, старый путь от конца последнего.
+    // Пути между k концами считаются Флойдом-Уоршеллом за k^3, затем каждая строка
+    // релаксируется через те концы, до которых путь стал короче
+    template <typename Weight>
+    void Router<Weight>::RelaxRoutesThroughEdges(const std::vector<EdgeId>& edge_ids, size_t thread_count) {
+        const size_t vertex_count = routes_internal_data_.GetVertexCount();
+        static constexpr size_t NO_INDEX = std::numeric_limits<size_t>::max();
+        std::vector<size_t> endpoint_indices(vertex_count, NO_INDEX);
+        std::vector<VertexId> endpoints;
+        auto add_endpoint = [&](VertexId vertex) {
+            if (endpoint_indices[vertex] == NO_INDEX) {
+                endpoint_indices[vertex] = endpoints.size();
+                endpoints.push_back(vertex);
+            }
+        };
+        for (const EdgeId edge_id : edge_ids) {
+            add_endpoint(graph_.GetEdge(edge_id).from);
+            add_endpoint(graph_.GetEdge(edge_id).to);
+        }
+        const size_t endpoint_count = endpoints.size();
+
+        std::vector<RouteInternalData> between(endpoint_count * endpoint_count);
+        for (size_t from = 0; from < endpoint_count; ++from) {
+            for (size_t to = 0; to < endpoint_count; ++to) {
+                between[from * endpoint_count + to] = routes_internal_data_[endpoints[from]][endpoints[to]];
+            }
+        }
+        for (const EdgeId edge_id : edge_ids) {
+            const Edge<Weight>& edge = graph_.GetEdge(edge_id);
+            auto& route = between[endpoint_indices[edge.from] * endpoint_count + endpoint_indices[edge.to]];
+            const auto weight = static_cast<StoredWeight>(edge.weight);
+            if (weight < route.weight) {
+                route = RouteInternalData{weight, static_cast<uint32_t>(edge_id)};
+            }
+        }
+        for (size_t through = 0; through < endpoint_count; ++through) {
+            for (size_t from = 0; from < endpoint_count; ++from) {
+                const RouteInternalData route_from = between[from * endpoint_count + through];
+                if (!route_from.HasRoute()) {
+                    continue;
+                }
+                RelaxRow(between.data() + from * endpoint_count, between.data() + through * endpoint_count,
+                         endpoint_count, route_from);
+            }
+        }
+
+        // Строки концов копируются до изменения, чтобы строки можно было обновлять параллельно
+        std::vector<RouteInternalData> endpoint_rows(endpoint_count * vertex_count);
+        for (size_t index = 0; index < endpoint_count; ++index) {
+            std::copy(routes_internal_data_[endpoints[index]], routes_internal_data_[endpoints[index]] + vertex_count,
+                      endpoint_rows.begin() + index * vertex_count);
+        }
+
+        parallel::ParallelFor(vertex_count, thread_count, [&](size_t from) {
+            RouteInternalData* row = routes_internal_data_[from];
+            std::vector<RouteInternalData> to_endpoints(endpoint_count);
+            for (size_t through = 0; through < endpoint_count; ++through) {
+                const RouteInternalData route_from = row[endpoints[through]];
+                if (!route_from.HasRoute()) {
+                    continue;
+                }
+                RelaxRow(to_endpoints.data(), between.data() + through * endpoint_count, endpoint_count, route_from);
+            }
+            for (size_t through = 0; through < endpoint_count; ++through) {
+                const RouteInternalData route_from = to_endpoints[through];
+                if (!route_from.HasRoute() || !(route_from.weight < row[endpoints[through]].weight)) {
+                    continue;
+                }
+                RelaxRow(row, endpoint_rows.data() + through * vertex_count, vertex_count, route_from);
+            }
+        });
+    }
 
 }
\ No newline at end of file
@@ -0,0 +1,311 @@
+#include "dijkstra_router.h"
+#include "min_plus.h"
+#include "router.h"
+#include "vertex_order.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+// Микробенчмарки маршрутизации.
+// Ядро min-plus: полный проход Флойда — Уоршелла по случайной плотной таблице для каждого доступного
+// набора инструкций, результаты сравниваются побайтно с обычным циклом.
+// Типы весов: построение таблицы Флойда — Уоршелла и поиск Дейкстры на одном случайном графе
+// с весами-минутами double и целыми сотыми долями секунды uint32_t.
+// Нумерация вершин: построение таблицы и поиск Дейкстры на сетке остановок при случайной нумерации
+// (как при обходе хеш-таблицы), обратном порядке Катхилла — Макки и порядке кривой Гильберта.
+// Использование: router_benchmark [vertex_count]
+
+namespace {
+
+    using graph::min_plus::InstructionSet;
+
+    template <typename StoredWeight>
+    struct Cell {
+        StoredWeight weight;
+        uint32_t prev_edge;
+    };
+
+    template <typename StoredWeight>
+    constexpr StoredWeight NO_ROUTE = std::numeric_limits<StoredWeight>::max();
+    constexpr uint32_t NO_PREV_EDGE = std::numeric_limits<uint32_t>::max();
+
+    // Прямое ребро есть у десятой части пар, остальные пути появляются при релаксации
+    template <typename StoredWeight>
+    std::vector<Cell<StoredWeight>> MakeTable(size_t vertex_count) {
+        std::mt19937 generator(42);
+        std::uniform_int_distribution<uint32_t> weights(1, 1000);
+        std::bernoulli_distribution has_edge(0.1);
+        std::vector<Cell<StoredWeight>> table(vertex_count * vertex_count, {NO_ROUTE<StoredWeight>, NO_PREV_EDGE});
+        uint32_t edge_id = 0;
+        for (size_t from = 0; from < vertex_count; ++from) {
+            for (size_t to = 0; to < vertex_count; ++to) {
+                if (from == to) {
+                    table[from * vertex_count + to] = {StoredWeight{}, NO_PREV_EDGE};
+                } else if (has_edge(generator)) {
+                    table[from * vertex_count + to] = {static_cast<StoredWeight>(weights(generator)), edge_id++};
+                }
+            }
+        }
+        return table;
+    }
+
+    template <typename StoredWeight>
+    double RunFloydWarshall(std::vector<Cell<StoredWeight>>& table, size_t vertex_count, InstructionSet instruction_set) {
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t through = 0; through < vertex_count; ++through) {
+            const Cell<StoredWeight>* row_through = table.data() + through * vertex_count;
+            for (size_t from = 0; from < vertex_count; ++from) {
+                Cell<StoredWeight>* row = table.data() + from * vertex_count;
+                const Cell<StoredWeight> route_from = row[through];
+                if (route_from.weight == NO_ROUTE<StoredWeight>) {
+                    continue;
+                }
+                graph::min_plus::RelaxRow(row, row_through, vertex_count, route_from, NO_ROUTE<StoredWeight>,
+                                          NO_PREV_EDGE, instruction_set);
+            }
+        }
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    template <typename StoredWeight>
+    bool Benchmark(const std::string& weight_name, size_t vertex_count) {
+        const auto source = MakeTable<StoredWeight>(vertex_count);
+        std::vector<InstructionSet> instruction_sets{InstructionSet::SCALAR};
+        if (graph::min_plus::GetInstructionSet() != InstructionSet::SCALAR) {
+            instruction_sets.push_back(InstructionSet::SSE);
+        }
+        if (graph::min_plus::GetInstructionSet() == InstructionSet::AVX2) {
+            instruction_sets.push_back(InstructionSet::AVX2);
+        }
+
+        bool is_equal = true;
+        std::vector<Cell<StoredWeight>> expected;
+        double scalar_time = 0.0;
+        for (const InstructionSet instruction_set : instruction_sets) {
+            auto table = source;
+            const double time = RunFloydWarshall(table, vertex_count, instruction_set);
+            if (instruction_set == InstructionSet::SCALAR) {
+                expected = table;
+                scalar_time = time;
+            } else if (std::memcmp(expected.data(), table.data(), table.size() * sizeof(table.front())) != 0) {
+                is_equal = false;
+            }
+            std::cout << std::setw(7) << weight_name << std::setw(8) << graph::min_plus::GetInstructionSetName(instruction_set)
+                      << std::fixed << std::setprecision(1) << std::setw(10) << time << " ms"
+                      << std::setprecision(2) << std::setw(8) << scalar_time / time << "x"
+                      << std::setprecision(2) << std::setw(8)
+                      << time * 1e6 / (static_cast<double>(vertex_count) * vertex_count * vertex_count) << " ns/cell\n";
+        }
+        return is_equal;
+    }
+
+
+    constexpr double WEIGHT_UNITS_PER_MINUTE = 6000.0;
+
+    // Граф из остановок с ребром ожидания и случайных поездок между ними, веса — минуты
+    graph::DirectedWeightedGraph<double> MakeGraph(size_t vertex_count) {
+        std::mt19937 generator(42);
+        const size_t stop_count = vertex_count / 2;
+        std::uniform_int_distribution<size_t> stops(0, stop_count - 1);
+        std::uniform_int_distribution<uint32_t> distances(100, 3000);
+        graph::DirectedWeightedGraph<double> graph(stop_count * 2);
+        for (size_t stop = 0; stop < stop_count; ++stop) {
+            graph.AddEdge({stop * 2, stop * 2 + 1, 6.0});
+        }
+        for (size_t i = 0; i < stop_count * 8; ++i) {
+            const size_t from = stops(generator);
+            const size_t to = stops(generator);
+            if (from != to) {
+                graph.AddEdge({from * 2 + 1, to * 2, distances(generator) / 1000.0 / 37.0 * 60});
+            }
+        }
+        graph.Freeze();
+        return graph;
+    }
+
+    graph::DirectedWeightedGraph<uint32_t> ToFixedPoint(const graph::DirectedWeightedGraph<double>& source) {
+        graph::DirectedWeightedGraph<uint32_t> graph(source.GetVertexCount());
+        for (const auto& edge : source.GetEdges()) {
+            graph.AddEdge({edge.from, edge.to, static_cast<uint32_t>(std::llround(edge.weight * WEIGHT_UNITS_PER_MINUTE))});
+        }
+        graph.Freeze();
+        return graph;
+    }
+
+    double ToMinutes(double weight) {
+        return weight;
+    }
+
+    double ToMinutes(uint32_t weight) {
+        return weight / WEIGHT_UNITS_PER_MINUTE;
+    }
+
+    template <typename Weight>
+    std::vector<double> BenchmarkWeight(const std::string& weight_name, const graph::DirectedWeightedGraph<Weight>& graph) {
+        const size_t vertex_count = graph.GetVertexCount();
+        auto start = std::chrono::steady_clock::now();
+        const graph::Router<Weight> router(graph, typename graph::Router<Weight>::BlockedBuild{});
+        const double build_time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        const size_t table_bytes = router.GetRoutesInternalData().GetCells().size()
+                                   * sizeof(router.GetRoutesInternalData().GetCells().front());
+
+        std::vector<graph::VertexId> targets(vertex_count);
+        for (graph::VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            targets[vertex] = vertex;
+        }
+        const graph::DijkstraRouter<Weight> dijkstra(graph);
+        const size_t query_count = std::min<size_t>(vertex_count, 256);
+        std::vector<double> minutes;
+        start = std::chrono::steady_clock::now();
+        for (graph::VertexId from = 0; from < query_count; ++from) {
+            for (const auto& route_info : dijkstra.BuildRoutes(from, targets)) {
+                minutes.push_back(route_info ? ToMinutes(route_info->weight) : -1.0);
+            }
+        }
+        const double query_time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << std::setw(7) << weight_name << std::fixed << std::setprecision(1)
+                  << "  Floyd-Warshall " << std::setw(8) << build_time << " ms, table " << std::setw(6)
+                  << table_bytes / (1024.0 * 1024.0) << " MiB"
+                  << "  Dijkstra " << std::setw(8) << query_time / query_count << " ms/source\n";
+        return minutes;
+    }
+
+
+    // Сетка side x side остановок, автобусы ходят по строкам и столбцам в обе стороны.
+    // Остановка с номером id получает вершины 2 * id и 2 * id + 1 и ребро ожидания между ними
+    graph::DirectedWeightedGraph<double> MakeGridGraph(size_t side, const std::vector<size_t>& stop_ids) {
+        graph::DirectedWeightedGraph<double> graph(side * side * 2);
+        for (size_t id = 0; id < side * side; ++id) {
+            graph.AddEdge({id * 2, id * 2 + 1, 6.0});
+        }
+        std::mt19937 generator(42);
+        std::uniform_real_distribution<double> ride_times(1.0, 3.0);
+        auto add_ride = [&](size_t from, size_t to) {
+            graph.AddEdge({stop_ids[from] * 2 + 1, stop_ids[to] * 2, ride_times(generator)});
+            graph.AddEdge({stop_ids[to] * 2 + 1, stop_ids[from] * 2, ride_times(generator)});
+        };
+        for (size_t row = 0; row < side; ++row) {
+            for (size_t column = 0; column < side; ++column) {
+                if (column + 1 < side) {
+                    add_ride(row * side + column, row * side + column + 1);
+                }
+                if (row + 1 < side) {
+                    add_ride(row * side + column, (row + 1) * side + column);
+                }
+            }
+        }
+        graph.Freeze();
+        return graph;
+    }
+
+    // Номер в графе для каждой остановки сетки по выбранному порядку
+    std::vector<size_t> GetGridStopIds(size_t side, const std::string& order_name) {
+        std::vector<size_t> order(side * side);
+        std::iota(order.begin(), order.end(), 0);
+        if (order_name == "random") {
+            std::shuffle(order.begin(), order.end(), std::mt19937(7));
+        } else if (order_name == "rcm") {
+            std::vector<std::vector<size_t>> adjacency(side * side);
+            for (size_t stop = 0; stop < side * side; ++stop) {
+                if (stop % side + 1 < side) {
+                    adjacency[stop].push_back(stop + 1);
+                    adjacency[stop + 1].push_back(stop);
+                }
+                if (stop + side < side * side) {
+                    adjacency[stop].push_back(stop + side);
+                    adjacency[stop + side].push_back(stop);
+                }
+            }
+            order = vertex_order::GetReverseCuthillMcKeeOrder(adjacency);
+        } else if (order_name == "hilbert") {
+            std::vector<Coordinates> coordinates(side * side);
+            for (size_t stop = 0; stop < side * side; ++stop) {
+                coordinates[stop] = {static_cast<double>(stop / side), static_cast<double>(stop % side)};
+            }
+            order = vertex_order::GetHilbertOrder(coordinates);
+        }
+        std::vector<size_t> stop_ids(side * side);
+        for (size_t id = 0; id < order.size(); ++id) {
+            stop_ids[order[id]] = id;
+        }
+        return stop_ids;
+    }
+
+    // Возвращает сумму весов найденных маршрутов: она не должна зависеть от нумерации
+    double BenchmarkVertexOrder(const std::string& order_name, size_t table_side, size_t search_side) {
+        auto stop_ids = GetGridStopIds(table_side, order_name);
+        const auto table_graph = MakeGridGraph(table_side, stop_ids);
+        auto start = std::chrono::steady_clock::now();
+        const graph::Router<double> router(table_graph, graph::Router<double>::BlockedBuild{});
+        const double build_time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        stop_ids = GetGridStopIds(search_side, order_name);
+        const auto search_graph = MakeGridGraph(search_side, stop_ids);
+        const graph::DijkstraRouter<double> dijkstra(search_graph);
+        std::mt19937 generator(42);
+        std::uniform_int_distribution<size_t> stops(0, search_side * search_side - 1);
+        constexpr size_t QUERY_COUNT = 64;
+        double weight_sum = 0.0;
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < QUERY_COUNT; ++i) {
+            const size_t from = stop_ids[stops(generator)] * 2;
+            const size_t to = stop_ids[stops(generator)] * 2;
+            if (const auto route_info = dijkstra.BuildRoute(from, to)) {
+                weight_sum += route_info->weight;
+            }
+        }
+        const double query_time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << std::setw(8) << order_name << std::fixed << std::setprecision(1)
+                  << "  Floyd-Warshall " << std::setw(8) << build_time << " ms (" << table_graph.GetVertexCount() << " vertices)"
+                  << "  Dijkstra " << std::setw(8) << query_time / QUERY_COUNT << " ms/query ("
+                  << search_graph.GetVertexCount() << " vertices)\n";
+        return weight_sum;
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    const size_t vertex_count = argc > 1 ? std::stoul(argv[1]) : 1024;
+    std::cout << "vertices: " << vertex_count
+              << ", best instruction set: " << graph::min_plus::GetInstructionSetName(graph::min_plus::GetInstructionSet()) << '\n';
+    bool is_equal = Benchmark<float>("float", vertex_count);
+    is_equal = Benchmark<uint32_t>("uint32", vertex_count) && is_equal;
+    is_equal = Benchmark<int32_t>("int32", vertex_count) && is_equal;
+    if (!is_equal) {
+        std::cerr << "Vectorized results differ from scalar ones\n";
+        return 1;
+    }
+
+    const auto graph = MakeGraph(vertex_count);
+    const auto minutes = BenchmarkWeight("double", graph);
+    const auto fixed_point_minutes = BenchmarkWeight("uint32", ToFixedPoint(graph));
+    double max_difference = 0.0;
+    for (size_t i = 0; i < minutes.size(); ++i) {
+        max_difference = std::max(max_difference, std::abs(minutes[i] - fixed_point_minutes[i]));
+    }
+    std::cout << "max travel time difference: " << std::scientific << std::setprecision(2) << max_difference << " min\n";
+
+    const auto table_side = static_cast<size_t>(std::sqrt(static_cast<double>(vertex_count) / 2));
+    constexpr size_t SEARCH_SIDE = 512;
+    std::vector<double> weight_sums;
+    for (const std::string order_name : {"random", "rcm", "hilbert"}) {
+        weight_sums.push_back(BenchmarkVertexOrder(order_name, table_side, SEARCH_SIDE));
+    }
+    if (std::any_of(weight_sums.begin(), weight_sums.end(), [&](double sum) { return std::abs(sum - weight_sums.front()) > 1e-6; })) {
+        std::cerr << "Routes depend on vertex order\n";
+        return 1;
+    }
+    return 0;
+}
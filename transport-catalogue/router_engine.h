@@ -0,0 +1,48 @@
+#pragma once
+
+#include "graph.h"
+
+#include <optional>
+#include <vector>
+
+namespace graph {
+
+    template <typename Weight>
+    struct RouteInfo {
+        Weight weight;
+        std::vector<EdgeId> edges;
+    };
+
+    // Счётчики поисковых движков: число запросов и суммарное число окончательно обработанных вершин
+    struct SearchStats {
+        size_t query_count = 0;
+        size_t settled_count = 0;
+    };
+
+    // Общий интерфейс всех движков поиска маршрута поверх DirectedWeightedGraph
+    template <typename Weight>
+    class RouterEngine {
+    public:
+        virtual ~RouterEngine() = default;
+
+        virtual std::optional<RouteInfo<Weight>> BuildRoute(VertexId from, VertexId to) const = 0;
+
+        // Маршруты из одной вершины во все targets в том же порядке. По умолчанию — по одному запросу
+        // на цель, движки без предрасчёта переопределяют его одним деревом кратчайших путей
+        virtual std::vector<std::optional<RouteInfo<Weight>>> BuildRoutes(VertexId from,
+                                                                         const std::vector<VertexId>& targets) const {
+            std::vector<std::optional<RouteInfo<Weight>>> routes;
+            routes.reserve(targets.size());
+            for (const VertexId to : targets) {
+                routes.push_back(BuildRoute(from, to));
+            }
+            return routes;
+        }
+
+        // Движки с предрасчитанными маршрутами счётчиков не ведут
+        virtual std::optional<SearchStats> GetSearchStats() const {
+            return std::nullopt;
+        }
+    };
+
+}
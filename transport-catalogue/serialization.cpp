@@ -1,8 +1,11 @@
 #include "serialization.h"
 #include "svg.h"
 
+#include <algorithm>
 #include <deque>
 #include <graph.pb.h>
+#include <iterator>
+#include <type_traits>
 #include <variant>
 #include <unordered_map>
 
@@ -14,12 +17,52 @@ namespace serial_handler {
     using namespace map_renderer;
     using EdgeInfo = std::variant<WaitEdgeInfo, BusEdgeInfo>;
 
+    namespace {
+        // База с таблицей маршрутов: заголовок, сообщение protobuf, выравнивание до границы страницы
+        // и таблица по строкам в памятном представлении ячеек. Сообщение protobuf не может начинаться
+        // с нулевого байта, поэтому базы без таблицы по-прежнему записываются одним сообщением
+        constexpr char BASE_MAGIC[8] = {'\0', 'T', 'C', 'B', 'A', 'S', 'E', '1'};
+        constexpr uint64_t ROUTE_TABLE_ALIGNMENT = 4096;
+
+        struct BaseHeader {
+            char magic[8];
+            uint64_t message_size;
+            uint64_t route_table_offset;
+            uint64_t route_table_size;
+        };
+
+        bool HasBaseMagic(const BaseHeader& header) {
+            return std::equal(std::begin(BASE_MAGIC), std::end(BASE_MAGIC), header.magic);
+        }
+
+        void CheckBaseHeader(const BaseHeader& header, size_t cell_size) {
+            if (header.route_table_offset < sizeof(BaseHeader) + header.message_size
+                || header.route_table_size % cell_size != 0) {
+                throw std::runtime_error("Corrupted routes matrix in serialized base");
+            }
+        }
+    }
+
     const SerializationSettings& SerialHandler::GetSettings() const {
         return settings_;
     }
 
     void SerialHandler::Serialization(std::ostream& output) {
+        if (route_table_.empty()) {
+            transport_catalogue_proto_.SerializeToOstream(&output);
+            return;
+        }
+        BaseHeader header{};
+        std::copy(std::begin(BASE_MAGIC), std::end(BASE_MAGIC), header.magic);
+        header.message_size = transport_catalogue_proto_.ByteSizeLong();
+        header.route_table_offset = (sizeof(header) + header.message_size + ROUTE_TABLE_ALIGNMENT - 1)
+                                    / ROUTE_TABLE_ALIGNMENT * ROUTE_TABLE_ALIGNMENT;
+        header.route_table_size = route_table_.size_bytes();
+        output.write(reinterpret_cast<const char*>(&header), sizeof(header));
         transport_catalogue_proto_.SerializeToOstream(&output);
+        const std::string padding(header.route_table_offset - sizeof(header) - header.message_size, '\0');
+        output.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+        output.write(reinterpret_cast<const char*>(route_table_.data()), static_cast<std::streamsize>(header.route_table_size));
     }
 
     void SerialHandler::SerializationTransportCatalogue(TransportCatalogue& transport_catalogue) {
@@ -90,68 +133,98 @@ namespace serial_handler {
 
     void SerialHandler::SerializationTransportRouter(TransportRouter& transport_router) {
         SerializationRoutingSettings(transport_router.GetRoutingSettings());
+        transport_catalogue_proto_.mutable_transport_router()->set_weight_units_per_minute(WEIGHT_UNITS_PER_MINUTE);
         SerializationGraph(transport_router.GetGraph());
-        SerializationRouter(transport_router.GetRouter());
+        switch (transport_router.GetRoutingSettings().router_type_) {
+            case RouterType::FLOYD_WARSHALL:
+            case RouterType::FLOYD_WARSHALL_BLOCKED:
+                SerializationRouter(dynamic_cast<const graph::Router<Weight>&>(transport_router.GetRouter()));
+                break;
+            case RouterType::CONTRACTION_HIERARCHIES:
+                SerializationContractionHierarchy(dynamic_cast<const graph::ContractionHierarchy<Weight>&>(transport_router.GetRouter()));
+                break;
+            case RouterType::HUB_LABELS:
+                SerializationHubLabels(dynamic_cast<const graph::HubLabels<Weight>&>(transport_router.GetRouter()));
+                break;
+            case RouterType::DIJKSTRA:
+            case RouterType::A_STAR:
+            case RouterType::BIDIRECTIONAL_DIJKSTRA:
+            case RouterType::RAPTOR:
+                break;
+        }
         SerializationStopAsPairNumber(transport_router.GetStopAsPairNumber());
         SerializationEdgeidToType(transport_router.GetEdgeidToType());
+        SerializationEdgeidToRide(transport_router.GetEdgeidToRide());
+        SerializationRawEdgeWeights(transport_router.GetRawEdgeWeights());
     }
 
     void SerialHandler::SerializationRoutingSettings(const RoutingSettings& routing_settings) {
         transport_router_proto::RoutingSettings* routing_settings_proto = transport_catalogue_proto_.mutable_transport_router()->mutable_routing_settings();
         routing_settings_proto->set_bus_velocity(routing_settings.bus_velocity_);
         routing_settings_proto->set_bus_wait_time(routing_settings.bus_wait_time_);
+        routing_settings_proto->set_router_type(static_cast<transport_router_proto::RouterType>(routing_settings.router_type_));
+        routing_settings_proto->set_graph_model(static_cast<transport_router_proto::GraphModel>(routing_settings.graph_model_));
+        routing_settings_proto->set_route_cache_capacity(routing_settings.route_cache_capacity_);
+        routing_settings_proto->set_vertex_order(static_cast<transport_router_proto::VertexOrder>(routing_settings.vertex_order_));
+        routing_settings_proto->set_prune_parallel_edges(routing_settings.prune_parallel_edges_);
     }
 
-    void SerialHandler::SerializationGraph(const graph::DirectedWeightedGraph<double>& graph) {
+    void SerialHandler::SerializationGraph(const graph::DirectedWeightedGraph<Weight>& graph) {
         graph_proto::DirectedWeightedGraph* graph_proto = transport_catalogue_proto_.mutable_transport_router()->mutable_graph();
-        graph_proto->set_vertex_count(graph.GetEdgeCount());
-        SerializationEdgesFromGraph(graph.GetEdges());
-        SerializationIncidenceListsFromGraph(graph.GetIncidenceList());
+        graph_proto->set_vertex_count(graph.GetVertexCount());
+        const auto& incidence_offsets = graph.GetIncidenceOffsets();
+        graph_proto->mutable_incidence_offsets()->Add(incidence_offsets.begin(), incidence_offsets.end());
+        SerializationIncidentEdgesFromGraph(graph.GetAllIncidentEdges());
     }
 
-    void SerialHandler::SerializationEdgesFromGraph(const std::vector<graph::Edge<double>>& edges) {
+void SerialHandler::SerializationIncidentEdgesFromGraph(const graph::DirectedWeightedGraph<Weight>::IncidenceList& incident_edges) {
     graph_proto::DirectedWeightedGraph* graph_proto = transport_catalogue_proto_.mutable_transport_router()->mutable_graph();
-    for (auto& edge : edges) {
-    graph_proto::Edge* edge_proto = graph_proto->add_edges();
-    edge_proto->set_from_edge(edge.from);
-    edge_proto->set_to_edge(edge.to);
-    edge_proto->set_weight(edge.weight);
+    graph_proto->mutable_edge_ids()->Reserve(incident_edges.size());
+    graph_proto->mutable_edge_targets()->Reserve(incident_edges.size());
+    graph_proto->mutable_edge_weights()->Reserve(incident_edges.size());
+    for (const auto& edge : incident_edges) {
+        graph_proto->add_edge_ids(edge.id);
+        graph_proto->add_edge_targets(edge.to);
+        graph_proto->add_edge_weights(edge.weight);
+    }
 }
+
+
+void SerialHandler::SerializationRouter(const graph::Router<Weight>& router) {
+    graph_proto::Router* router_proto = transport_catalogue_proto_.mutable_transport_router()->mutable_router();
+    const typename graph::Router<Weight>::RoutesInternalData& routes_internal_data = router.GetRoutesInternalData();
+    router_proto->set_vertex_count(routes_internal_data.GetVertexCount());
+    route_table_ = routes_internal_data.GetCells();
 }
 
-void SerialHandler::SerializationIncidenceListsFromGraph(const std::vector<graph::DirectedWeightedGraph<double>::IncidenceList>& incidence_lists) {
-    graph_proto::DirectedWeightedGraph* graph_proto = transport_catalogue_proto_.mutable_transport_router()->mutable_graph();
-    for (auto& incidence_list : incidence_lists) {
-        graph_proto::IncidenceList* incidence_list_proto = graph_proto->mutable_incidence_lists()->Add();
-        for (auto edge_id: incidence_list) {
-            incidence_list_proto->add_edge_id(edge_id);
-        }
+void SerialHandler::SerializationContractionHierarchy(const graph::ContractionHierarchy<Weight>& contraction_hierarchy) {
+    graph_proto::ContractionHierarchy* hierarchy_proto = transport_catalogue_proto_.mutable_transport_router()->mutable_contraction_hierarchy();
+    const auto& ranks = contraction_hierarchy.GetRanks();
+    hierarchy_proto->mutable_ranks()->Add(ranks.begin(), ranks.end());
+    for (const auto& shortcut : contraction_hierarchy.GetShortcuts()) {
+        hierarchy_proto->add_shortcut_from(shortcut.from);
+        hierarchy_proto->add_shortcut_to(shortcut.to);
+        hierarchy_proto->add_shortcut_weight(shortcut.weight);
+        hierarchy_proto->add_shortcut_first(shortcut.first);
+        hierarchy_proto->add_shortcut_second(shortcut.second);
     }
 }
 
-
-void SerialHandler::SerializationRouter(const graph::Router<double>& router) {
-    graph_proto::Router* router_proto = transport_catalogue_proto_.mutable_transport_router()->mutable_router();
-    const typename graph::Router<double>::RoutesInternalData& routes_internal_data = router.GetRoutesInternalData();
-    for (const auto& route : routes_internal_data) {
-        graph_proto::RoutesInternalData* routes_internal_data_proto = router_proto->add_routes_internal_data();
-        for (const auto& data : route) {
-            graph_proto::RouteInternalData* route_internal_data_proto = routes_internal_data_proto->add_route_internal_data();
-            if (data) {
-                route_internal_data_proto->set_has_data(true);
-                route_internal_data_proto->set_weight(data->weight);
-                if (data->prev_edge) {
-                    route_internal_data_proto->set_has_prev_edge(true);
-                    route_internal_data_proto->set_prev_edge(data->prev_edge.value());
-                } else {
-                    route_internal_data_proto->set_has_prev_edge(false);
-                }
-            } else {
-                route_internal_data_proto->set_has_data(false);
-                route_internal_data_proto->set_has_prev_edge(false);
-            }
+void SerialHandler::SerializationHubLabels(const graph::HubLabels<Weight>& hub_labels) {
+    graph_proto::HubLabels* hub_labels_proto = transport_catalogue_proto_.mutable_transport_router()->mutable_hub_labels();
+    auto serialize_labels = [](const graph::HubLabels<Weight>::Labels& labels, graph_proto::Labels* labels_proto) {
+        labels_proto->mutable_offsets()->Add(labels.offsets.begin(), labels.offsets.end());
+        labels_proto->mutable_hubs()->Reserve(labels.entries.size());
+        labels_proto->mutable_weights()->Reserve(labels.entries.size());
+        labels_proto->mutable_edges()->Reserve(labels.entries.size());
+        for (const auto& entry : labels.entries) {
+            labels_proto->add_hubs(entry.hub);
+            labels_proto->add_weights(entry.weight);
+            labels_proto->add_edges(entry.edge);
         }
-    }
+    };
+    serialize_labels(hub_labels.GetForwardLabels(), hub_labels_proto->mutable_forward());
+    serialize_labels(hub_labels.GetBackwardLabels(), hub_labels_proto->mutable_backward());
 }
 
 void SerialHandler::SerializationStopAsPairNumber(const std::unordered_map<transport_catalogue::stop::Stop*, StopPairVertexId>& stop_as_pair_number) {
@@ -186,6 +259,26 @@ void SerialHandler::SerializationEdgeidToType(const std::unordered_map<graph::Ed
     }
 }
 
+void SerialHandler::SerializationEdgeidToRide(const std::unordered_map<graph::EdgeId, RideEdgeInfo>& edge_id_to_ride) {
+    auto& edge_id_to_ride_proto = *transport_catalogue_proto_.mutable_transport_router()->mutable_edge_id_to_ride();
+    for (const auto& [id, ride] : edge_id_to_ride) {
+        transport_router_proto::RideEdgeInfo ride_edge_proto;
+        ride_edge_proto.set_bus_name(string(ride.bus_name));
+        ride_edge_proto.set_distance(ride.distance);
+        edge_id_to_ride_proto[id] = move(ride_edge_proto);
+    }
+}
+
+void SerialHandler::SerializationRawEdgeWeights(const std::vector<RawEdgeWeight>& raw_edge_weights) {
+    auto& raw_edge_weights_proto = *transport_catalogue_proto_.mutable_transport_router()->mutable_raw_edge_weights();
+    raw_edge_weights_proto.Reserve(raw_edge_weights.size());
+    for (const auto& raw_weight : raw_edge_weights) {
+        transport_router_proto::RawEdgeWeight* raw_weight_proto = raw_edge_weights_proto.Add();
+        raw_weight_proto->set_distance(raw_weight.distance);
+        raw_weight_proto->set_wait_count(raw_weight.wait_count);
+    }
+}
+
 void SerialHandler::SerializationColor(svg_proto::Color* color_proto, const svg::Color& color) {
     if (holds_alternative<string>(color)) {
         string get_color = std::get<string>(color);
@@ -209,7 +302,48 @@ void SerialHandler::SerializationColor(svg_proto::Color* color_proto, const svg:
 
 void SerialHandler::Deserialize(std::istream& input) {
     transport_catalogue_proto_.Clear();
-    transport_catalogue_proto_.ParseFromIstream(&input);
+    BaseHeader header{};
+    if (!input.read(reinterpret_cast<char*>(&header), sizeof(header)) || !HasBaseMagic(header)) {
+        input.clear();
+        input.seekg(0);
+        transport_catalogue_proto_.ParseFromIstream(&input);
+        return;
+    }
+    CheckBaseHeader(header, sizeof(RouteInternalData));
+    std::string message(header.message_size, '\0');
+    input.read(message.data(), static_cast<std::streamsize>(message.size()));
+    transport_catalogue_proto_.ParseFromString(message);
+    input.ignore(static_cast<std::streamsize>(header.route_table_offset - sizeof(header) - header.message_size));
+    route_table_cells_.resize(header.route_table_size / sizeof(RouteInternalData));
+    input.read(reinterpret_cast<char*>(route_table_cells_.data()), static_cast<std::streamsize>(header.route_table_size));
+    if (!input) {
+        throw std::runtime_error("Corrupted routes matrix in serialized base");
+    }
+    has_appended_route_table_ = true;
+}
+
+void SerialHandler::DeserializeMapped() {
+    transport_catalogue_proto_.Clear();
+    mapped_file_ = std::make_shared<MappedFile>(settings_.name_file);
+    const char* data = mapped_file_->GetData();
+    const size_t size = mapped_file_->GetSize();
+    BaseHeader header{};
+    if (size >= sizeof(header)) {
+        std::copy(data, data + sizeof(header), reinterpret_cast<char*>(&header));
+    }
+    if (!HasBaseMagic(header)) {
+        transport_catalogue_proto_.ParseFromArray(data, static_cast<int>(size));
+        mapped_file_.reset();
+        return;
+    }
+    CheckBaseHeader(header, sizeof(RouteInternalData));
+    if (header.route_table_offset + header.route_table_size > size) {
+        throw std::runtime_error("Corrupted routes matrix in serialized base");
+    }
+    transport_catalogue_proto_.ParseFromArray(data + sizeof(header), static_cast<int>(header.message_size));
+    route_table_ = {reinterpret_cast<const RouteInternalData*>(data + header.route_table_offset),
+                    header.route_table_size / sizeof(RouteInternalData)};
+    has_appended_route_table_ = true;
 }
 
 TransportCatalogue SerialHandler::GetTransportCatalogue() {
@@ -225,12 +359,40 @@ RenderSettings SerialHandler::GetMapRenderSettings() {
 }
 
 TransportRouter SerialHandler::GetTransportRouter(TransportCatalogue& transport_catalogue) {
-        auto settings = DeserializeRoutingSettings();
-        TransportRouter transport_router(settings);
-        transport_router.SetGraph(DeserializeEdgesFromGraph(), DeserializeIncidenceListsFromGraph());
-        transport_router.SetRouter(DeserializeRouter());
+        routing_settings_ = DeserializeRoutingSettings();
+        if (transport_catalogue_proto_.transport_router().weight_units_per_minute() != WEIGHT_UNITS_PER_MINUTE) {
+            throw std::runtime_error("Serialized base was built with another edge weight type");
+        }
+        TransportRouter transport_router(routing_settings_);
+        transport_router.SetGraph(DeserializeGraph());
         transport_router.SetStopAsPairNumber(DeserializeStopAsPairNumber(transport_catalogue));
         transport_router.SetEdgeidToType(DeserializeEdgeidToType(transport_catalogue));
+        transport_router.SetEdgeidToRide(DeserializeEdgeidToRide(transport_catalogue));
+        transport_router.SetRawEdgeWeights(DeserializeRawEdgeWeights());
+        switch (routing_settings_.router_type_) {
+            case RouterType::FLOYD_WARSHALL:
+            case RouterType::FLOYD_WARSHALL_BLOCKED:
+                transport_router.SetRouter(DeserializeRouter());
+                break;
+            case RouterType::CONTRACTION_HIERARCHIES:
+                DeserializeContractionHierarchy(transport_router);
+                break;
+            case RouterType::HUB_LABELS:
+                DeserializeHubLabels(transport_router);
+                break;
+            case RouterType::DIJKSTRA:
+            case RouterType::A_STAR:
+            case RouterType::BIDIRECTIONAL_DIJKSTRA:
+                transport_router.BuildRouter();
+                break;
+            case RouterType::RAPTOR:
+                transport_router.BuildRaptorRouter(transport_catalogue);
+                break;
+        }
+        if (routing_settings_.router_type_ != RouterType::RAPTOR) {
+            transport_router.BuildGraphRouters();
+        }
+        transport_router.ResetRouteCache();
         return transport_router;
 }
 
@@ -322,55 +484,95 @@ transport_catalogue::RoutingSettings SerialHandler::DeserializeRoutingSettings()
     const transport_router_proto::RoutingSettings& routing_settings_proto = transport_catalogue_proto_.transport_router().routing_settings();
     routing_settings.bus_velocity_ = routing_settings_proto.bus_velocity();
     routing_settings.bus_wait_time_ = routing_settings_proto.bus_wait_time();
+    routing_settings.router_type_ = static_cast<transport_catalogue::RouterType>(routing_settings_proto.router_type());
+    routing_settings.graph_model_ = static_cast<transport_catalogue::GraphModel>(routing_settings_proto.graph_model());
+    routing_settings.route_cache_capacity_ = routing_settings_proto.route_cache_capacity();
+    routing_settings.vertex_order_ = static_cast<transport_catalogue::VertexOrder>(routing_settings_proto.vertex_order());
+    routing_settings.prune_parallel_edges_ = routing_settings_proto.prune_parallel_edges();
     return routing_settings;
 }
 
-std::vector<graph::Edge<double>> SerialHandler::DeserializeEdgesFromGraph() {
+graph::DirectedWeightedGraph<Weight> SerialHandler::DeserializeGraph() {
     const graph_proto::DirectedWeightedGraph& graph_proto = transport_catalogue_proto_.transport_router().graph();
-    std::vector<graph::Edge<double>> edges(graph_proto.edges_size());
-    for (size_t i = 0; i < graph_proto.edges_size(); ++i) {
-        const graph_proto::Edge& edge_proto = graph_proto.edges(i);
-        edges[i] = {edge_proto.from_edge(), edge_proto.to_edge(), edge_proto.weight()};
+    std::vector<size_t> incidence_offsets(graph_proto.incidence_offsets().begin(), graph_proto.incidence_offsets().end());
+    const size_t edge_count = graph_proto.edge_ids_size();
+    if (graph_proto.edge_targets_size() != edge_count || graph_proto.edge_weights_size() != edge_count) {
+        throw std::runtime_error("Corrupted graph in serialized base");
     }
-    return edges;
+    graph::DirectedWeightedGraph<Weight>::IncidenceList incident_edges(edge_count);
+    for (size_t i = 0; i < edge_count; ++i) {
+        incident_edges[i] = {graph_proto.edge_ids(i), graph_proto.edge_targets(i), static_cast<Weight>(graph_proto.edge_weights(i))};
+    }
+    return graph::DirectedWeightedGraph<Weight>(std::move(incidence_offsets), std::move(incident_edges));
 }
 
-std::vector<graph::DirectedWeightedGraph<double>::IncidenceList> SerialHandler::DeserializeIncidenceListsFromGraph() {
-    const graph_proto::DirectedWeightedGraph& graph_proto = transport_catalogue_proto_.transport_router().graph();
-    std::vector<graph::DirectedWeightedGraph<double>::IncidenceList> incidence_lists(graph_proto.incidence_lists_size());
-    for (size_t i = 0; i < graph_proto.incidence_lists_size(); ++i) {
-        const graph_proto::IncidenceList& incidence_list_proto = graph_proto.incidence_lists(i);
-        for (size_t j = 0; j < incidence_list_proto.edge_id_size(); ++j) {
-            incidence_lists[i].push_back(incidence_list_proto.edge_id(j));
+graph::Router<Weight>::RoutesInternalData SerialHandler::DeserializeRouter() {
+    const graph_proto::Router& router_proto = transport_catalogue_proto_.transport_router().router();
+    if (has_appended_route_table_) {
+        const size_t vertex_count = router_proto.vertex_count();
+        const size_t cell_count = mapped_file_ ? route_table_.size() : route_table_cells_.size();
+        if (cell_count != vertex_count * vertex_count) {
+            throw std::runtime_error("Corrupted routes matrix in serialized base");
         }
+        if (mapped_file_) {
+            // Ячейки живут, пока жив отображённый файл
+            return {vertex_count, std::shared_ptr<const RouteInternalData>(mapped_file_, route_table_.data())};
+        }
+        return {vertex_count, std::move(route_table_cells_)};
+    }
+    const auto& weights_proto = [&router_proto]() -> const auto& {
+        if constexpr (std::is_integral_v<Weight>) {
+            return router_proto.integer_weights();
+        } else {
+            return router_proto.weights();
+        }
+    }();
+    if (weights_proto.size() != router_proto.prev_edges_size()) {
+        throw std::runtime_error("Corrupted routes matrix in serialized base");
+    }
+    std::vector<graph::Router<Weight>::RouteInternalData> cells(weights_proto.size());
+    for (size_t i = 0; i < cells.size(); ++i) {
+        cells[i] = {weights_proto.Get(i), router_proto.prev_edges(i)};
     }
-    return incidence_lists;
+    return graph::Router<Weight>::RoutesInternalData(router_proto.vertex_count(), std::move(cells));
 }
 
-graph::Router<double>::RoutesInternalData SerialHandler::DeserializeRouter() {
-    const graph_proto::Router router_proto = transport_catalogue_proto_.transport_router().router();
-    graph::Router<double>::RoutesInternalData routes_internal_data(router_proto.routes_internal_data_size());
-    for (size_t i = 0; i < router_proto.routes_internal_data_size(); ++i) {
-        const graph_proto::RoutesInternalData routes_internal_data_proto = router_proto.routes_internal_data(i);
-        for (size_t j = 0; j < routes_internal_data_proto.route_internal_data_size(); ++j) {
-            const graph_proto::RouteInternalData& route_internal_data_proto = routes_internal_data_proto.route_internal_data(j);
-            graph::Router<double>::RouteInternalData route_internal_data;
-            if (route_internal_data_proto.has_data()) {
-                route_internal_data.weight = route_internal_data_proto.weight();
-                if (route_internal_data_proto.has_prev_edge()) {
-                    route_internal_data.prev_edge = route_internal_data_proto.prev_edge();
-                }
-                routes_internal_data[i].push_back(move(route_internal_data));
-            } else {
-                routes_internal_data[i].push_back(nullopt);
-            }
-        }
+void SerialHandler::DeserializeContractionHierarchy(TransportRouter& transport_router) {
+    const graph_proto::ContractionHierarchy& hierarchy_proto = transport_catalogue_proto_.transport_router().contraction_hierarchy();
+    std::vector<size_t> ranks(hierarchy_proto.ranks().begin(), hierarchy_proto.ranks().end());
+    const size_t shortcut_count = hierarchy_proto.shortcut_from_size();
+    if (hierarchy_proto.shortcut_to_size() != shortcut_count || hierarchy_proto.shortcut_weight_size() != shortcut_count
+        || hierarchy_proto.shortcut_first_size() != shortcut_count || hierarchy_proto.shortcut_second_size() != shortcut_count) {
+        throw std::runtime_error("Corrupted contraction hierarchy in serialized base");
     }
-    return routes_internal_data;
+    std::vector<graph::ContractionHierarchy<Weight>::Shortcut> shortcuts(shortcut_count);
+    for (size_t i = 0; i < shortcut_count; ++i) {
+        shortcuts[i] = {hierarchy_proto.shortcut_from(i), hierarchy_proto.shortcut_to(i), static_cast<Weight>(hierarchy_proto.shortcut_weight(i)),
+                        hierarchy_proto.shortcut_first(i), hierarchy_proto.shortcut_second(i)};
+    }
+    transport_router.SetRouter(std::move(ranks), std::move(shortcuts));
+}
+
+void SerialHandler::DeserializeHubLabels(TransportRouter& transport_router) {
+    const graph_proto::HubLabels& hub_labels_proto = transport_catalogue_proto_.transport_router().hub_labels();
+    auto deserialize_labels = [](const graph_proto::Labels& labels_proto) {
+        const size_t entry_count = labels_proto.hubs_size();
+        if (labels_proto.weights_size() != entry_count || labels_proto.edges_size() != entry_count) {
+            throw std::runtime_error("Corrupted hub labels in serialized base");
+        }
+        graph::HubLabels<Weight>::Labels labels;
+        labels.offsets.assign(labels_proto.offsets().begin(), labels_proto.offsets().end());
+        labels.entries.resize(entry_count);
+        for (size_t i = 0; i < entry_count; ++i) {
+            labels.entries[i] = {labels_proto.hubs(i), static_cast<Weight>(labels_proto.weights(i)), labels_proto.edges(i)};
+        }
+        return labels;
+    };
+    transport_router.SetRouter(deserialize_labels(hub_labels_proto.forward()), deserialize_labels(hub_labels_proto.backward()));
 }
 
 std::unordered_map<transport_catalogue::stop::Stop*, StopPairVertexId> SerialHandler::DeserializeStopAsPairNumber(
-        TransportCatalogue transport_catalogue) {
+        TransportCatalogue& transport_catalogue) {
     const auto& stop_as_pair_number_proto = transport_catalogue_proto_.transport_router().stop_id_to_pair_vertex_id();
     std::unordered_map<transport_catalogue::stop::Stop*, StopPairVertexId> stop_as_pair_number(stop_as_pair_number_proto.size());
     for (const auto& [stop, vertex] : stop_as_pair_number_proto) {
@@ -380,7 +582,7 @@ std::unordered_map<transport_catalogue::stop::Stop*, StopPairVertexId> SerialHan
 }
 
 std::unordered_map<graph::EdgeId, EdgeInfo> SerialHandler::DeserializeEdgeidToType(
-        TransportCatalogue transport_catalogue) {
+        TransportCatalogue& transport_catalogue) {
     const auto& edge_id_to_type_proto = transport_catalogue_proto_.transport_router().edge_id_to_type();
     std::unordered_map<graph::EdgeId, EdgeInfo> edge_id_to_type(edge_id_to_type_proto.size());
     for (const auto& [id, info] : edge_id_to_type_proto) {
@@ -397,5 +599,24 @@ std::unordered_map<graph::EdgeId, EdgeInfo> SerialHandler::DeserializeEdgeidToTy
     }
     return edge_id_to_type;
 }
+std::unordered_map<graph::EdgeId, RideEdgeInfo> SerialHandler::DeserializeEdgeidToRide(
+        TransportCatalogue& transport_catalogue) {
+    const auto& edge_id_to_ride_proto = transport_catalogue_proto_.transport_router().edge_id_to_ride();
+    std::unordered_map<graph::EdgeId, RideEdgeInfo> edge_id_to_ride(edge_id_to_ride_proto.size());
+    for (const auto& [id, ride] : edge_id_to_ride_proto) {
+        edge_id_to_ride[id] = {transport_catalogue.GetBusInfo(ride.bus_name())->name, ride.distance()};
+    }
+    return edge_id_to_ride;
+}
+
+std::vector<RawEdgeWeight> SerialHandler::DeserializeRawEdgeWeights() {
+    const auto& raw_edge_weights_proto = transport_catalogue_proto_.transport_router().raw_edge_weights();
+    std::vector<RawEdgeWeight> raw_edge_weights;
+    raw_edge_weights.reserve(raw_edge_weights_proto.size());
+    for (const auto& raw_weight : raw_edge_weights_proto) {
+        raw_edge_weights.push_back({raw_weight.distance(), raw_weight.wait_count()});
+    }
+    return raw_edge_weights;
+}
 
-}
\ No newline at end of file
+}
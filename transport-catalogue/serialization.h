@@ -4,10 +4,13 @@
 #include "transport_catalogue.h"
 #include "map_renderer.h"
 #include "transport_router.h"
+#include "mapped_file.h"
 
 #include <deque>
+#include <memory>
 #include <optional>
 #include <iostream>
+#include <span>
 #include <transport_router.pb.h>
 #include <transport_catalogue.pb.h>
 #include <svg.pb.h>
@@ -28,8 +31,13 @@ namespace serial_handler {
 
         void SerializationTransportRouter(transport_router::TransportRouter& transport_router);
 
+        // Читает базу целиком, включая таблицу маршрутов
         void Deserialize(std::istream& input);
 
+        // Отображает файл базы в память: таблица маршрутов не копируется, её строки читаются
+        // с диска по мере обращения запросов. Таблица такой базы доступна только для чтения
+        void DeserializeMapped();
+
         transport_catalogue::TransportCatalogue GetTransportCatalogue();
 
         map_renderer::RenderSettings GetMapRenderSettings();
@@ -43,9 +51,19 @@ namespace serial_handler {
     private:
         SerializationSettings settings_;
         transport_catalogue_serialize::TransportCatalogue transport_catalogue_proto_;
+        transport_catalogue::RoutingSettings routing_settings_;
         std::deque<transport_catalogue::stop::Stop> stops_;
         std::deque<transport_catalogue::bus::Bus> buses_;
 
+        using RouteInternalData = graph::Router<transport_router::Weight>::RouteInternalData;
+
+        // Таблица маршрутов пишется в файл после сообщения protobuf. При записи это ячейки движка,
+        // при чтении отображённой базы — ячейки внутри mapped_file_, при чтении из потока — route_table_cells_
+        std::span<const RouteInternalData> route_table_;
+        std::shared_ptr<const MappedFile> mapped_file_;
+        std::vector<RouteInternalData> route_table_cells_;
+        bool has_appended_route_table_ = false;
+
     private:
         void SerializationStops(const std::unordered_map<std::string_view, transport_catalogue::stop::Stop*>& stops);
 
@@ -67,31 +85,44 @@ namespace serial_handler {
 
         void SerializationRoutingSettings(const transport_catalogue::RoutingSettings& routing_settings);
 
-        void SerializationGraph(const graph::DirectedWeightedGraph<double>& graph);
+        void SerializationGraph(const graph::DirectedWeightedGraph<transport_router::Weight>& graph);
 
-        void SerializationEdgesFromGraph(const std::vector<graph::Edge<double>>& edges);
+        void SerializationIncidentEdgesFromGraph(const graph::DirectedWeightedGraph<transport_router::Weight>::IncidenceList& incident_edges);
 
-        void SerializationIncidenceListsFromGraph(const std::vector<graph::DirectedWeightedGraph<double>::IncidenceList>& incidence_lists);
+        void SerializationRouter(const graph::Router<transport_router::Weight>& router);
 
-        void SerializationRouter(const graph::Router<double>& router);
+        void SerializationContractionHierarchy(const graph::ContractionHierarchy<transport_router::Weight>& contraction_hierarchy);
+
+        void SerializationHubLabels(const graph::HubLabels<transport_router::Weight>& hub_labels);
 
         void SerializationStopAsPairNumber(const std::unordered_map<transport_catalogue::stop::Stop*, StopPairVertexId>& stop_as_pair_number_);
 
         void SerializationEdgeidToType(const std::unordered_map<graph::EdgeId, EdgeInfo>& edge_id_to_type_);
 
+        void SerializationEdgeidToRide(const std::unordered_map<graph::EdgeId, RideEdgeInfo>& edge_id_to_ride);
+
+        void SerializationRawEdgeWeights(const std::vector<RawEdgeWeight>& raw_edge_weights);
+
         transport_catalogue::RoutingSettings DeserializeRoutingSettings();
 
-        std::vector<graph::Edge<double>> DeserializeEdgesFromGraph();
+        graph::DirectedWeightedGraph<transport_router::Weight> DeserializeGraph();
+
+        graph::Router<transport_router::Weight>::RoutesInternalData DeserializeRouter();
 
-        std::vector<graph::DirectedWeightedGraph<double>::IncidenceList> DeserializeIncidenceListsFromGraph();
+        void DeserializeContractionHierarchy(transport_router::TransportRouter& transport_router);
 
-        graph::Router<double>::RoutesInternalData DeserializeRouter();
+        void DeserializeHubLabels(transport_router::TransportRouter& transport_router);
 
         std::unordered_map<transport_catalogue::stop::Stop*, StopPairVertexId> DeserializeStopAsPairNumber(
-                transport_catalogue::TransportCatalogue transport_catalogue);
+                transport_catalogue::TransportCatalogue& transport_catalogue);
 
         std::unordered_map<graph::EdgeId, EdgeInfo> DeserializeEdgeidToType(
-                transport_catalogue::TransportCatalogue transport_catalogue);
+                transport_catalogue::TransportCatalogue& transport_catalogue);
+
+        std::unordered_map<graph::EdgeId, RideEdgeInfo> DeserializeEdgeidToRide(
+                transport_catalogue::TransportCatalogue& transport_catalogue);
+
+        std::vector<RawEdgeWeight> DeserializeRawEdgeWeights();
 
     };
 
@@ -35,9 +35,45 @@ namespace transport_catalogue {
         };
     }
 
+    enum class RouterType {
+        FLOYD_WARSHALL,
+        DIJKSTRA,
+        FLOYD_WARSHALL_BLOCKED,
+        CONTRACTION_HIERARCHIES,
+        RAPTOR,
+        A_STAR,
+        BIDIRECTIONAL_DIJKSTRA,
+        HUB_LABELS,
+    };
+
+    // STOP_PAIRS — ребро на каждую пару остановок автобуса, LINE_GRAPH — цепочка вершин-перегонов
+    // с рёбрами посадки и высадки, число рёбер линейно по длине маршрута.
+    // SINGLE_VERTEX — рёбра как в STOP_PAIRS, но одна вершина на остановку: ожидание входит в вес ребра автобуса
+    enum class GraphModel {
+        STOP_PAIRS,
+        LINE_GRAPH,
+        SINGLE_VERTEX,
+    };
+
+    // Нумерация вершин остановок при построении графа. NONE — порядок обхода хеш-таблицы остановок,
+    // RCM — обратный порядок Катхилла — Макки по соседству остановок на маршрутах,
+    // HILBERT — порядок координат остановок вдоль кривой Гильберта
+    enum class VertexOrder {
+        NONE,
+        RCM,
+        HILBERT,
+    };
+
     struct RoutingSettings {
         int bus_wait_time_;
         double bus_velocity_;
+        RouterType router_type_ = RouterType::FLOYD_WARSHALL;
+        GraphModel graph_model_ = GraphModel::STOP_PAIRS;
+        VertexOrder vertex_order_ = VertexOrder::NONE;
+        // Оставлять из параллельных рёбер только самое лёгкое. Расстояния в такой базе менять нельзя
+        bool prune_parallel_edges_ = false;
+        // Ёмкость кэша готовых маршрутов, 0 — кэш выключен
+        size_t route_cache_capacity_ = 0;
     };
 
     class TransportCatalogue {
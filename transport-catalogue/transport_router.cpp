@@ -1,46 +1,383 @@
 #include "transport_router.h"
 
+#include <algorithm>
+#include <numeric>
+#include <tuple>
+
 namespace transport_router {
 
     void TransportRouter::BuildTransportRouter(transport_catalogue::TransportCatalogue& catalogue) {
-        graph_ = std::make_unique<graph::DirectedWeightedGraph<double>>(catalogue.GetAllStops().size() * 2);
-        GetStops(catalogue.GetAllStops());
-        LoadWaitEdges();
-        LoadBusEdges(catalogue);
-        router_ = std::make_unique<graph::Router<double>>(*graph_);
+        const bool is_raptor = settings_.router_type_ == transport_catalogue::RouterType::RAPTOR;
+        const bool is_line_graph = settings_.graph_model_ == transport_catalogue::GraphModel::LINE_GRAPH;
+        const bool is_single_vertex = settings_.graph_model_ == transport_catalogue::GraphModel::SINGLE_VERTEX;
+        size_t vertex_count = catalogue.GetAllStops().size() * (is_single_vertex ? 1 : 2);
+        if (is_line_graph && !is_raptor) {
+            vertex_count += CountRideVertices(catalogue);
+        }
+        graph_ = std::make_unique<graph::DirectedWeightedGraph<Weight>>(vertex_count);
+        GetStops(OrderStops(catalogue));
+        if (is_raptor) {
+            graph_->Freeze();
+            BuildRaptorRouter(catalogue);
+            ResetRouteCache();
+            return;
+        }
+        if (!is_single_vertex) {
+            LoadWaitEdges();
+        }
+        if (is_line_graph) {
+            LoadBusLines(catalogue);
+        } else {
+            LoadBusEdges(catalogue);
+        }
+        if (settings_.prune_parallel_edges_) {
+            PruneParallelEdges();
+        }
+        graph_->Freeze();
+        BuildRouter();
+        BuildGraphRouters();
+        ResetRouteCache();
+    }
+
+    std::vector<transport_catalogue::stop::Stop*> TransportRouter::OrderStops(transport_catalogue::TransportCatalogue& catalogue) const {
+        std::vector<transport_catalogue::stop::Stop*> stops;
+        stops.reserve(catalogue.GetAllStops().size());
+        for (const auto& [name, stop] : catalogue.GetAllStops()) {
+            stops.push_back(stop);
+        }
+        std::vector<size_t> order;
+        switch (settings_.vertex_order_) {
+            case transport_catalogue::VertexOrder::NONE:
+                return stops;
+            case transport_catalogue::VertexOrder::HILBERT: {
+                std::vector<Coordinates> coordinates;
+                coordinates.reserve(stops.size());
+                for (const auto* stop : stops) {
+                    coordinates.push_back(stop->coordinates);
+                }
+                order = vertex_order::GetHilbertOrder(coordinates);
+                break;
+            }
+            case transport_catalogue::VertexOrder::RCM: {
+                // Соседи — остановки, идущие подряд на маршруте какого-либо автобуса
+                std::unordered_map<transport_catalogue::stop::Stop*, size_t> indices;
+                for (size_t i = 0; i < stops.size(); ++i) {
+                    indices[stops[i]] = i;
+                }
+                std::vector<std::vector<size_t>> adjacency(stops.size());
+                for (const auto& [name, bus] : catalogue.GetAllBuses()) {
+                    for (size_t i = 1; i < bus->route.size(); ++i) {
+                        const size_t from = indices.at(bus->route[i - 1]);
+                        const size_t to = indices.at(bus->route[i]);
+                        if (from != to) {
+                            adjacency[from].push_back(to);
+                            adjacency[to].push_back(from);
+                        }
+                    }
+                }
+                for (auto& neighbors : adjacency) {
+                    std::sort(neighbors.begin(), neighbors.end());
+                    neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+                }
+                order = vertex_order::GetReverseCuthillMcKeeOrder(adjacency);
+                break;
+            }
+        }
+        std::vector<transport_catalogue::stop::Stop*> ordered_stops;
+        ordered_stops.reserve(stops.size());
+        for (const size_t index : order) {
+            ordered_stops.push_back(stops[index]);
+        }
+        return ordered_stops;
     }
 
-    void TransportRouter::GetStops(const std::unordered_map<std::string_view, transport_catalogue::stop::Stop *>& stops) {
+    void TransportRouter::GetStops(const std::vector<transport_catalogue::stop::Stop*>& stops) {
+        const bool is_single_vertex = settings_.graph_model_ == transport_catalogue::GraphModel::SINGLE_VERTEX;
         size_t count = 0;
-        for (auto stop: stops) {
+        for (auto* stop : stops) {
             graph::VertexId first_id = count++;
-            graph::VertexId second_id = count++;
-            stop_as_pair_number_[stop.second] = StopPairVertexId{first_id, second_id};
+            graph::VertexId second_id = is_single_vertex ? first_id : count++;
+            stop_as_pair_number_[stop] = StopPairVertexId{first_id, second_id};
+        }
+        IndexStopVertices();
+    }
+
+    void TransportRouter::IndexStopVertices() {
+        vertex_stop_names_.clear();
+        for (const auto& [stop, pair_vertex_id] : stop_as_pair_number_) {
+            if (pair_vertex_id.bus_wait_begin >= vertex_stop_names_.size()) {
+                vertex_stop_names_.resize(pair_vertex_id.bus_wait_begin + 1);
+            }
+            vertex_stop_names_[pair_vertex_id.bus_wait_begin] = stop->name;
         }
     }
 
+    // Рёбра ожидания нумеруются в порядке вершин своих остановок
     void TransportRouter::LoadWaitEdges() {
-        for (const auto& [stop, pair_vertex_id]: stop_as_pair_number_) {
-            graph::EdgeId edge_id = graph_->AddEdge({pair_vertex_id.bus_wait_begin, pair_vertex_id.bus_wait_end,static_cast<double>(settings_.bus_wait_time_)});
+        std::vector<std::pair<StopPairVertexId, transport_catalogue::stop::Stop*>> stops;
+        stops.reserve(stop_as_pair_number_.size());
+        for (const auto& [stop, pair_vertex_id] : stop_as_pair_number_) {
+            stops.push_back({pair_vertex_id, stop});
+        }
+        std::sort(stops.begin(), stops.end(), [](const auto& lhs, const auto& rhs) {
+            return lhs.first.bus_wait_begin < rhs.first.bus_wait_begin;
+        });
+        for (const auto& [pair_vertex_id, stop] : stops) {
+            graph::EdgeId edge_id = AddEdge({pair_vertex_id.bus_wait_begin, pair_vertex_id.bus_wait_end, ToWeight(settings_.bus_wait_time_)}, {0, 1});
             edgeid_to_edgeinfo_[edge_id] = WaitEdgeInfo{stop->name, static_cast<double>(settings_.bus_wait_time_)};
         }
     }
 
-    void TransportRouter::LoadBusEdges(transport_catalogue::TransportCatalogue catalogue) {
-        auto& buses = catalogue.GetAllBuses();
-        for (const auto& [name, bus]: buses) {
-            if (bus->circle) {
-                ProcessRoute(bus->route.begin(), bus->route.end(), catalogue, name);
+    void TransportRouter::LoadBusEdges(transport_catalogue::TransportCatalogue& catalogue) {
+        std::vector<transport_catalogue::bus::Bus*> buses;
+        buses.reserve(catalogue.GetAllBuses().size());
+        for (const auto& [name, bus] : catalogue.GetAllBuses()) {
+            buses.push_back(bus);
+        }
+        AddBusEdges(BuildBusEdges(catalogue, buses));
+    }
+
+    TransportRouter::BusEdges TransportRouter::BuildBusEdges(transport_catalogue::TransportCatalogue& catalogue,
+                                                             const std::vector<transport_catalogue::bus::Bus*>& buses) const {
+        // Рёбра соединяют каждую остановку направления со всеми следующими
+        std::vector<size_t> offsets(buses.size() + 1, 0);
+        for (size_t i = 0; i < buses.size(); ++i) {
+            const size_t stop_count = buses[i]->route.size();
+            const size_t edge_count = stop_count > 0 ? stop_count * (stop_count - 1) / 2 : 0;
+            offsets[i + 1] = offsets[i] + (buses[i]->circle ? edge_count : 2 * edge_count);
+        }
+        BusEdges bus_edges;
+        bus_edges.edges.resize(offsets.back());
+        bus_edges.raw_weights.resize(offsets.back());
+        bus_edges.infos.resize(offsets.back());
+        parallel::ParallelFor(buses.size(), parallel::GetThreadCount(), [&](size_t index) {
+            const transport_catalogue::bus::Bus* bus = buses[index];
+            const size_t position = ProcessRoute(bus->route.begin(), bus->route.end(), catalogue, bus->name, bus_edges, offsets[index]);
+            if (!bus->circle) {
+                ProcessRoute(bus->route.rbegin(), bus->route.rend(), catalogue, bus->name, bus_edges, position);
+            }
+        });
+        return bus_edges;
+    }
+
+    void TransportRouter::AddBusEdges(BusEdges&& bus_edges) {
+        edgeid_to_edgeinfo_.reserve(edgeid_to_edgeinfo_.size() + bus_edges.edges.size());
+        raw_edge_weights_.reserve(raw_edge_weights_.size() + bus_edges.edges.size());
+        for (size_t i = 0; i < bus_edges.edges.size(); ++i) {
+            const graph::EdgeId edge_id = AddEdge(bus_edges.edges[i], bus_edges.raw_weights[i]);
+            edgeid_to_edgeinfo_.emplace(edge_id, std::move(bus_edges.infos[i]));
+        }
+    }
+
+    size_t TransportRouter::CountRideVertices(transport_catalogue::TransportCatalogue& catalogue) const {
+        size_t count = 0;
+        for (const auto& [name, bus] : catalogue.GetAllBuses()) {
+            count += bus->circle ? bus->route.size() : bus->route.size() * 2;
+        }
+        return count;
+    }
+
+    // Вершины-перегоны нумеруются после пар вершин остановок
+    void TransportRouter::LoadBusLines(transport_catalogue::TransportCatalogue& catalogue) {
+        graph::VertexId ride_vertex = stop_as_pair_number_.size() * 2;
+        for (const auto& [name, bus] : catalogue.GetAllBuses()) {
+            ride_vertex = ProcessLine(bus->route.begin(), bus->route.end(), catalogue, name, ride_vertex);
+            if (!bus->circle) {
+                ride_vertex = ProcessLine(bus->route.rbegin(), bus->route.rend(), catalogue, name, ride_vertex);
+            }
+        }
+    }
+
+    void TransportRouter::PruneParallelEdges() {
+        const auto& edges = graph_->GetEdges();
+        std::vector<graph::EdgeId> edge_ids(edges.size());
+        std::iota(edge_ids.begin(), edge_ids.end(), 0);
+        auto get_key = [&](graph::EdgeId id) {
+            return std::tuple{edges[id].from, edges[id].to, edges[id].weight, raw_edge_weights_[id].distance, id};
+        };
+        std::sort(edge_ids.begin(), edge_ids.end(), [&](graph::EdgeId lhs, graph::EdgeId rhs) {
+            return get_key(lhs) < get_key(rhs);
+        });
+        std::vector<bool> is_kept(edges.size(), false);
+        for (size_t i = 0; i < edge_ids.size(); ++i) {
+            const auto& edge = edges[edge_ids[i]];
+            is_kept[edge_ids[i]] = i == 0 || edge.from != edges[edge_ids[i - 1]].from || edge.to != edges[edge_ids[i - 1]].to;
+        }
+
+        // Оставшиеся рёбра перенумеровываются подряд в прежнем порядке
+        auto graph = std::make_unique<graph::DirectedWeightedGraph<Weight>>(graph_->GetVertexCount());
+        std::unordered_map<graph::EdgeId, EdgeInfo> edgeid_to_edgeinfo;
+        std::unordered_map<graph::EdgeId, RideEdgeInfo> edgeid_to_ride;
+        std::vector<RawEdgeWeight> raw_edge_weights;
+        for (graph::EdgeId id = 0; id < edges.size(); ++id) {
+            if (!is_kept[id]) {
+                continue;
+            }
+            const graph::EdgeId new_id = graph->AddEdge(edges[id]);
+            raw_edge_weights.push_back(raw_edge_weights_[id]);
+            if (auto it = edgeid_to_edgeinfo_.find(id); it != edgeid_to_edgeinfo_.end()) {
+                edgeid_to_edgeinfo.emplace(new_id, std::move(it->second));
+            }
+            if (auto it = edgeid_to_ride_.find(id); it != edgeid_to_ride_.end()) {
+                edgeid_to_ride.emplace(new_id, std::move(it->second));
+            }
+        }
+        pruned_edge_count_ = edges.size() - graph->GetEdgeCount();
+        graph_ = std::move(graph);
+        edgeid_to_edgeinfo_ = std::move(edgeid_to_edgeinfo);
+        edgeid_to_ride_ = std::move(edgeid_to_ride);
+        raw_edge_weights_ = std::move(raw_edge_weights);
+    }
+
+    size_t TransportRouter::GetPrunedEdgeCount() const {
+        return pruned_edge_count_;
+    }
+
+    void TransportRouter::BuildRouter() {
+        switch (settings_.router_type_) {
+            case transport_catalogue::RouterType::DIJKSTRA:
+                router_ = std::make_unique<graph::DijkstraRouter<Weight>>(*graph_);
+                break;
+            case transport_catalogue::RouterType::FLOYD_WARSHALL:
+                router_ = std::make_unique<graph::Router<Weight>>(*graph_);
+                break;
+            case transport_catalogue::RouterType::FLOYD_WARSHALL_BLOCKED:
+                router_ = std::make_unique<graph::Router<Weight>>(*graph_, graph::Router<Weight>::BlockedBuild{});
+                break;
+            case transport_catalogue::RouterType::CONTRACTION_HIERARCHIES:
+                router_ = std::make_unique<graph::ContractionHierarchy<Weight>>(*graph_);
+                break;
+            case transport_catalogue::RouterType::A_STAR:
+                router_ = std::make_unique<graph::AStarRouter<Weight>>(*graph_, BuildGeoLowerBound());
+                break;
+            case transport_catalogue::RouterType::BIDIRECTIONAL_DIJKSTRA:
+                router_ = std::make_unique<graph::BidirectionalDijkstraRouter<Weight>>(*graph_);
+                break;
+            case transport_catalogue::RouterType::HUB_LABELS:
+                router_ = std::make_unique<graph::HubLabels<Weight>>(*graph_);
+                break;
+            case transport_catalogue::RouterType::RAPTOR:
+                throw std::logic_error("RAPTOR router is built from the catalogue, not from the graph");
+        }
+    }
+
+    // Нижняя оценка времени в пути — расстояние по прямой, умноженное на наименьшее по всем рёбрам
+    // отношение веса к расстоянию между концами. Дорожные расстояния в справочнике не обязаны быть
+    // больше геодезических, поэтому делить только на bus_velocity_ было бы недопустимо
+    graph::AStarRouter<Weight>::LowerBound TransportRouter::BuildGeoLowerBound() const {
+        std::vector<Coordinates> coordinates(graph_->GetVertexCount());
+        for (const auto& [stop, pair_vertex_id] : stop_as_pair_number_) {
+            coordinates[pair_vertex_id.bus_wait_begin] = stop->coordinates;
+            coordinates[pair_vertex_id.bus_wait_end] = stop->coordinates;
+        }
+        // Вершины-перегоны модели LINE_GRAPH получают координаты своей остановки по рёбрам посадки и высадки
+        std::vector<bool> is_stop_vertex(graph_->GetVertexCount(), false);
+        for (const auto& [stop, pair_vertex_id] : stop_as_pair_number_) {
+            is_stop_vertex[pair_vertex_id.bus_wait_begin] = true;
+            is_stop_vertex[pair_vertex_id.bus_wait_end] = true;
+        }
+        for (graph::EdgeId id = 0; id < graph_->GetEdgeCount(); ++id) {
+            if (edgeid_to_edgeinfo_.count(id) || edgeid_to_ride_.count(id)) {
+                continue;
+            }
+            const graph::Edge<Weight>& edge = graph_->GetEdge(id);
+            if (is_stop_vertex[edge.from]) {
+                coordinates[edge.to] = coordinates[edge.from];
             } else {
-                ProcessRoute(bus->route.begin(), bus->route.end(), catalogue, name);
-                ProcessRoute(bus->route.rbegin(), bus->route.rend(), catalogue, name);
+                coordinates[edge.from] = coordinates[edge.to];
+            }
+        }
+
+        std::optional<double> time_per_meter;
+        for (const auto& edge : graph_->GetEdges()) {
+            const double distance = ComputeDistance(coordinates[edge.from], coordinates[edge.to]);
+            if (distance > 0 && (!time_per_meter || static_cast<double>(edge.weight) / distance < *time_per_meter)) {
+                time_per_meter = static_cast<double>(edge.weight) / distance;
             }
         }
+        // Целая оценка округляется вниз, чтобы не превысить вес пути
+        return [coordinates = std::move(coordinates), time_per_meter = time_per_meter.value_or(0)](graph::VertexId from, graph::VertexId to) {
+            const double distance = ComputeDistance(coordinates[from], coordinates[to]);
+            const double bound = distance > 0 ? distance * time_per_meter : 0;
+            if constexpr (std::is_integral_v<Weight>) {
+                return static_cast<Weight>(std::floor(bound));
+            } else {
+                return bound;
+            }
+        };
     }
 
-    graph::Edge<double> TransportRouter::BuildBusEdge(transport_catalogue::stop::Stop *from, transport_catalogue::stop::Stop *to, const double distance) const {
+    // Граф при этом не содержит рёбер: поиск идёт прямо по последовательностям остановок
+    void TransportRouter::BuildRaptorRouter(transport_catalogue::TransportCatalogue& catalogue) {
+        std::vector<std::string_view> stop_names(graph_->GetVertexCount());
+        for (const auto& [stop, pair_vertex_id] : stop_as_pair_number_) {
+            stop_names[pair_vertex_id.bus_wait_begin] = stop->name;
+        }
+
+        std::vector<RaptorRouter::Line> lines;
+        auto add_line = [&](auto range_begin, auto range_end, std::string_view bus) {
+            RaptorRouter::Line line{bus, {}, {}};
+            uint64_t distance = 0;
+            for (auto stop = range_begin; stop != range_end; ++stop) {
+                if (stop != range_begin) {
+                    distance += catalogue.GetDistanceBetween(*prev(stop), *stop);
+                }
+                line.stops.push_back(stop_as_pair_number_.at(*stop).bus_wait_begin);
+                line.distances.push_back(distance);
+            }
+            lines.push_back(std::move(line));
+        };
+        for (const auto& [name, bus] : catalogue.GetAllBuses()) {
+            add_line(bus->route.begin(), bus->route.end(), name);
+            if (!bus->circle) {
+                add_line(bus->route.rbegin(), bus->route.rend(), name);
+            }
+        }
+
+        raptor_router_ = std::make_unique<RaptorRouter>(std::move(lines), std::move(stop_names),
+                                                         static_cast<double>(settings_.bus_wait_time_), settings_.bus_velocity_);
+    }
+
+    void TransportRouter::BuildGraphRouters() {
+        std::vector<bool> boarding_edges(graph_->GetEdgeCount(), false);
+        for (const auto& [edge_id, info] : edgeid_to_edgeinfo_) {
+            boarding_edges[edge_id] = GetBoardingWaitCount() > 0 ? std::holds_alternative<BusEdgeInfo>(info)
+                                                                  : std::holds_alternative<WaitEdgeInfo>(info);
+        }
+        pareto_router_ = std::make_unique<graph::ParetoRouter<Weight>>(*graph_, std::move(boarding_edges));
+        yen_router_ = std::make_unique<graph::YenRouter<Weight>>(*graph_);
+    }
+
+    graph::Edge<Weight> TransportRouter::BuildBusEdge(transport_catalogue::stop::Stop *from, transport_catalogue::stop::Stop *to, const double distance) const {
         return {stop_as_pair_number_.at(from).bus_wait_end, stop_as_pair_number_.at(to).bus_wait_begin,
-                (distance / 1000.0 / (settings_.bus_velocity_) * 60)};
+                GetEdgeWeight({static_cast<uint64_t>(distance), GetBoardingWaitCount()}, settings_)};
+    }
+
+    Weight TransportRouter::GetBusTime(const double distance) const {
+        return GetBusTime(distance, settings_);
+    }
+
+    Weight TransportRouter::GetBusTime(const double distance, const transport_catalogue::RoutingSettings& settings) const {
+        return ToWeight(distance / 1000.0 / (settings.bus_velocity_) * 60);
+    }
+
+    Weight TransportRouter::GetEdgeWeight(graph::EdgeId id, const transport_catalogue::RoutingSettings& settings) const {
+        return GetEdgeWeight(raw_edge_weights_.at(id), settings);
+    }
+
+    Weight TransportRouter::GetEdgeWeight(const RawEdgeWeight& raw_weight, const transport_catalogue::RoutingSettings& settings) const {
+        return raw_weight.wait_count * ToWeight(settings.bus_wait_time_) + GetBusTime(static_cast<double>(raw_weight.distance), settings);
+    }
+
+    uint32_t TransportRouter::GetBoardingWaitCount() const {
+        return settings_.graph_model_ == transport_catalogue::GraphModel::SINGLE_VERTEX ? 1 : 0;
+    }
+
+    graph::EdgeId TransportRouter::AddEdge(const graph::Edge<Weight>& edge, RawEdgeWeight raw_weight) {
+        const graph::EdgeId edge_id = graph_->AddEdge(edge);
+        raw_edge_weights_.resize(graph_->GetEdgeCount());
+        raw_edge_weights_[edge_id] = raw_weight;
+        return edge_id;
     }
 
     std::optional<StopPairVertexId> TransportRouter::GetPairVertexId(transport_catalogue::stop::Stop *stop) const {
@@ -55,30 +392,256 @@ namespace transport_router {
     }
 
     std::optional<RouteInfo> TransportRouter::GetRouteInfo(graph::VertexId from, graph::VertexId to) const {
-        std::optional<typename graph::Router<double>::RouteInfo> route_info = router_->BuildRoute(from, to);
-        if (route_info) {
-            RouteInfo result;
-            result.total_time = route_info->weight;
-            for (const auto edge: route_info->edges) {
-                result.edges.emplace_back(GetEdgeInfo(edge));
+        if (route_cache_) {
+            if (auto cached = route_cache_->Find(from, to)) {
+                return std::move(*cached);
+            }
+        }
+        std::optional<RouteInfo> result;
+        if (raptor_router_) {
+            result = raptor_router_->BuildRoute(from, to);
+        } else if (std::optional<graph::RouteInfo<Weight>> route_info = router_->BuildRoute(from, to)) {
+            result = ConvertRouteInfo(*route_info);
+        }
+        if (route_cache_) {
+            route_cache_->Insert(from, to, result);
+        }
+        return result;
+    }
+
+    std::optional<RouteInfo> TransportRouter::GetRouteInfo(graph::VertexId from, graph::VertexId to,
+                                                           const transport_catalogue::RoutingSettings& settings) const {
+        if (raptor_router_) {
+            return raptor_router_->BuildRoute(from, to, {static_cast<double>(settings.bus_wait_time_), settings.bus_velocity_});
+        }
+        if (raw_edge_weights_.size() != graph_->GetEdgeCount()) {
+            throw std::logic_error("Base has no raw edge weights for query-time routing settings");
+        }
+        size_t settled_count = 0;
+        auto route_infos = graph::BuildShortestPathTreeRoutes(*graph_, from, {to}, settled_count,
+                                                              [this, &settings](const graph::IncidentEdge<Weight>& edge) {
+                                                                  return GetEdgeWeight(edge.id, settings);
+                                                              });
+        if (!route_infos.front()) {
+            return std::nullopt;
+        }
+        return ConvertRouteInfo(*route_infos.front(), &settings);
+    }
+
+    // Из кэша берутся готовые маршруты, движок считает только остальные одним вызовом.
+    // Повторы одной цели считаются один раз и затем отдаются из кэша
+    std::vector<std::optional<RouteInfo>> TransportRouter::GetRouteInfos(graph::VertexId from, const std::vector<graph::VertexId>& targets) const {
+        std::vector<std::optional<RouteInfo>> result(targets.size());
+        std::unordered_map<graph::VertexId, size_t> first_indices;
+        std::vector<size_t> repeated_indices;
+        std::vector<size_t> missed_indices;
+        std::vector<graph::VertexId> missed_targets;
+        for (size_t i = 0; i < targets.size(); ++i) {
+            if (!first_indices.emplace(targets[i], i).second) {
+                repeated_indices.push_back(i);
+                continue;
+            }
+            std::optional<std::optional<RouteInfo>> cached;
+            if (route_cache_) {
+                cached = route_cache_->Find(from, targets[i]);
+            }
+            if (cached) {
+                result[i] = std::move(*cached);
+            } else {
+                missed_indices.push_back(i);
+                missed_targets.push_back(targets[i]);
+            }
+        }
+        if (raptor_router_) {
+            for (const size_t i : missed_indices) {
+                result[i] = raptor_router_->BuildRoute(from, targets[i]);
+            }
+        } else if (!missed_targets.empty()) {
+            std::vector<std::optional<graph::RouteInfo<Weight>>> route_infos = router_->BuildRoutes(from, missed_targets);
+            for (size_t j = 0; j < missed_indices.size(); ++j) {
+                if (route_infos[j]) {
+                    result[missed_indices[j]] = ConvertRouteInfo(*route_infos[j]);
+                }
+            }
+        }
+        if (route_cache_) {
+            for (const size_t i : missed_indices) {
+                route_cache_->Insert(from, targets[i], result[i]);
+            }
+        }
+        for (const size_t i : repeated_indices) {
+            if (route_cache_) {
+                if (auto cached = route_cache_->Find(from, targets[i])) {
+                    result[i] = std::move(*cached);
+                    continue;
+                }
+            }
+            result[i] = result[first_indices.at(targets[i])];
+        }
+        return result;
+    }
+
+    std::vector<RouteInfo> TransportRouter::GetParetoRouteInfos(graph::VertexId from, graph::VertexId to) const {
+        if (raptor_router_) {
+            return raptor_router_->BuildParetoRoutes(from, to);
+        }
+        std::vector<RouteInfo> result;
+        for (const auto& route_info : pareto_router_->BuildRoutes(from, to)) {
+            result.push_back(ConvertRouteInfo(route_info));
+        }
+        return result;
+    }
+
+    std::vector<RouteInfo> TransportRouter::GetAlternativeRouteInfos(graph::VertexId from, graph::VertexId to, size_t count) const {
+        std::vector<RouteInfo> result;
+        if (raptor_router_) {
+            if (std::optional<RouteInfo> route_info = raptor_router_->BuildRoute(from, to); route_info && count > 0) {
+                result.push_back(std::move(*route_info));
             }
             return result;
         }
-        return std::nullopt;
+        for (const auto& route_info : yen_router_->BuildRoutes(from, to, count)) {
+            result.push_back(ConvertRouteInfo(route_info));
+        }
+        return result;
+    }
+
+    std::vector<ReachableStop> TransportRouter::GetReachableStops(graph::VertexId from, double max_time) const {
+        std::vector<std::optional<double>> times;
+        if (raptor_router_) {
+            times = raptor_router_->BuildArrivalTimes(from, max_time);
+        } else {
+            times.resize(graph_->GetVertexCount());
+            for (const auto& [vertex, weight] : graph::BuildBoundedShortestPathWeights(*graph_, from, ToWeight(max_time))) {
+                times[vertex] = ToMinutes(weight);
+            }
+        }
+        std::vector<ReachableStop> result;
+        for (const auto& [stop, pair_vertex_id] : stop_as_pair_number_) {
+            if (const auto& time = times[pair_vertex_id.bus_wait_begin]) {
+                result.push_back({stop->name, *time});
+            }
+        }
+        std::sort(result.begin(), result.end(), [](const ReachableStop& lhs, const ReachableStop& rhs) {
+            return std::tie(lhs.time, lhs.stop_name) < std::tie(rhs.time, rhs.stop_name);
+        });
+        return result;
+    }
+
+    std::vector<std::vector<std::optional<double>>> TransportRouter::GetTravelTimeMatrix(const std::vector<graph::VertexId>& sources,
+                                                                                         const std::vector<graph::VertexId>& targets) const {
+        std::vector<std::vector<std::optional<double>>> result(sources.size());
+        parallel::ParallelFor(sources.size(), parallel::GetThreadCount(), [&](size_t index) {
+            std::vector<std::optional<double>>& row = result[index];
+            row.reserve(targets.size());
+            if (raptor_router_) {
+                const std::vector<std::optional<double>> times = raptor_router_->BuildArrivalTimes(sources[index], std::nullopt);
+                for (const graph::VertexId to : targets) {
+                    row.push_back(times.at(to));
+                }
+                return;
+            }
+            for (const auto& route_info : router_->BuildRoutes(sources[index], targets)) {
+                row.push_back(route_info ? std::optional<double>(ToMinutes(route_info->weight)) : std::nullopt);
+            }
+        });
+        return result;
+    }
+
+    RouteInfo TransportRouter::ConvertRouteInfo(const graph::RouteInfo<Weight>& route_info,
+                                                const transport_catalogue::RoutingSettings* settings) const {
+        RouteInfo result;
+        // Ожидание, входящее в вес ребра автобуса модели SINGLE_VERTEX, выдаётся отдельным элементом перед поездкой
+        auto add_edge_info = [this, settings, &result](graph::EdgeId edge) {
+            EdgeInfo info = GetEdgeInfo(edge);
+            const double wait_time = (settings ? settings : &settings_)->bus_wait_time_;
+            if (auto* bus_edge = std::get_if<BusEdgeInfo>(&info)) {
+                if (settings) {
+                    bus_edge->time = ToMinutes(GetBusTime(static_cast<double>(raw_edge_weights_.at(edge).distance), *settings));
+                }
+                if (GetBoardingWaitCount() > 0) {
+                    result.edges.emplace_back(WaitEdgeInfo{vertex_stop_names_.at(graph_->GetEdge(edge).from), wait_time});
+                }
+            } else if (settings) {
+                std::get<WaitEdgeInfo>(info).time = ToMinutes(GetEdgeWeight(edge, *settings));
+            }
+            result.edges.emplace_back(std::move(info));
+        };
+        if (edgeid_to_ride_.empty()) {
+            result.total_time = ToMinutes(route_info.weight);
+            for (const auto edge: route_info.edges) {
+                add_edge_info(edge);
+            }
+            return result;
+        }
+
+        // Подряд идущие перегоны между посадкой и высадкой склеиваются в одну поездку.
+        // Время поездки считается по суммарному расстоянию, как у ребра модели STOP_PAIRS
+        std::optional<BusEdgeInfo> ride;
+        uint64_t ride_distance = 0;
+        auto finish_ride = [&]() {
+            if (ride) {
+                ride->time = ToMinutes(GetBusTime(static_cast<double>(ride_distance), settings ? *settings : settings_));
+                result.edges.emplace_back(*ride);
+                ride.reset();
+            }
+        };
+        for (const auto edge: route_info.edges) {
+            if (auto ride_it = edgeid_to_ride_.find(edge); ride_it != edgeid_to_ride_.end()) {
+                if (!ride) {
+                    ride = BusEdgeInfo{ride_it->second.bus_name, 0, 0};
+                    ride_distance = 0;
+                }
+                ++ride->span_count;
+                ride_distance += ride_it->second.distance;
+                continue;
+            }
+            finish_ride();
+            if (edgeid_to_edgeinfo_.count(edge)) {
+                add_edge_info(edge);
+            }
+        }
+        finish_ride();
+        for (const auto& edge : result.edges) {
+            result.total_time += std::visit([](const auto& info) { return info.time; }, edge);
+        }
+        return result;
     }
 
     transport_catalogue::RoutingSettings& TransportRouter::GetRoutingSettings(){
         return settings_;
     }
 
-    const graph::DirectedWeightedGraph<double>& TransportRouter::GetGraph() const {
+    const graph::DirectedWeightedGraph<Weight>& TransportRouter::GetGraph() const {
         return *graph_;
     }
 
-    const graph::Router<double>& TransportRouter::GetRouter() const {
+    const graph::RouterEngine<Weight>& TransportRouter::GetRouter() const {
         return *router_;
     }
 
+    std::optional<graph::SearchStats> TransportRouter::GetSearchStats() const {
+        if (!router_) {
+            return std::nullopt;
+        }
+        return router_->GetSearchStats();
+    }
+
+    void TransportRouter::ResetRouteCache() {
+        if (settings_.route_cache_capacity_ > 0) {
+            route_cache_ = std::make_unique<RouteCache>(settings_.route_cache_capacity_);
+        } else {
+            route_cache_.reset();
+        }
+    }
+
+    std::optional<RouteCache::Stats> TransportRouter::GetRouteCacheStats() const {
+        if (!route_cache_) {
+            return std::nullopt;
+        }
+        return route_cache_->GetStats();
+    }
+
     const std::unordered_map<transport_catalogue::stop::Stop*, StopPairVertexId>& TransportRouter::GetStopAsPairNumber() const {
         return stop_as_pair_number_;
     }
@@ -87,19 +650,181 @@ namespace transport_router {
         return edgeid_to_edgeinfo_;
     }
 
-    void TransportRouter::SetGraph(std::vector<graph::Edge<double>>&& edges, std::vector<graph::DirectedWeightedGraph<double>::IncidenceList>&& incidence_lists) {
-        graph_ = std::make_unique<graph::DirectedWeightedGraph<double>>(move(edges), move(incidence_lists));
+    const std::unordered_map<graph::EdgeId, RideEdgeInfo>& TransportRouter::GetEdgeidToRide() const {
+        return edgeid_to_ride_;
+    }
+
+    const std::vector<RawEdgeWeight>& TransportRouter::GetRawEdgeWeights() const {
+        return raw_edge_weights_;
+    }
+
+    void TransportRouter::SetGraph(graph::DirectedWeightedGraph<Weight>&& graph) {
+        graph_ = std::make_unique<graph::DirectedWeightedGraph<Weight>>(std::move(graph));
     }
 
     void TransportRouter::SetStopAsPairNumber(std::unordered_map<transport_catalogue::stop::Stop*, StopPairVertexId>&& stop_as_pair_number) {
         stop_as_pair_number_ = std::move(stop_as_pair_number);
+        IndexStopVertices();
     }
 
     void TransportRouter::SetEdgeidToType(std::unordered_map<graph::EdgeId, EdgeInfo>&& edge_id_to_type) {
         edgeid_to_edgeinfo_ = std::move(edge_id_to_type);
     }
 
-    void TransportRouter::SetRouter(graph::Router<double>::RoutesInternalData&& routes_internal_data) {
-        router_ = std::make_unique<graph::Router<double>>(*graph_, std::move(routes_internal_data));
+    void TransportRouter::SetEdgeidToRide(std::unordered_map<graph::EdgeId, RideEdgeInfo>&& edge_id_to_ride) {
+        edgeid_to_ride_ = std::move(edge_id_to_ride);
+    }
+
+    void TransportRouter::SetRawEdgeWeights(std::vector<RawEdgeWeight>&& raw_edge_weights) {
+        raw_edge_weights_ = std::move(raw_edge_weights);
+    }
+
+    void TransportRouter::SetRouter(graph::Router<Weight>::RoutesInternalData&& routes_internal_data) {
+        router_ = std::make_unique<graph::Router<Weight>>(*graph_, std::move(routes_internal_data));
+    }
+
+    void TransportRouter::SetRouter(std::vector<size_t>&& ranks, std::vector<graph::ContractionHierarchy<Weight>::Shortcut>&& shortcuts) {
+        router_ = std::make_unique<graph::ContractionHierarchy<Weight>>(*graph_, std::move(ranks), std::move(shortcuts));
+    }
+
+    void TransportRouter::SetRouter(graph::HubLabels<Weight>::Labels&& forward_labels, graph::HubLabels<Weight>::Labels&& backward_labels) {
+        router_ = std::make_unique<graph::HubLabels<Weight>>(*graph_, std::move(forward_labels), std::move(backward_labels));
+    }
+
+    void TransportRouter::AddStop(transport_catalogue::TransportCatalogue& catalogue, transport_catalogue::stop::Stop* stop) {
+        if (stop_as_pair_number_.count(stop)) {
+            throw std::invalid_argument("Stop is already in the router");
+        }
+        catalogue.AddStop(stop->name, stop);
+        const bool is_single_vertex = settings_.graph_model_ == transport_catalogue::GraphModel::SINGLE_VERTEX;
+        const graph::VertexId first_id = graph_->AddVertices(is_single_vertex ? 1 : 2);
+        stop_as_pair_number_[stop] = StopPairVertexId{first_id, is_single_vertex ? first_id : first_id + 1};
+        vertex_stop_names_.resize(graph_->GetVertexCount());
+        vertex_stop_names_[first_id] = stop->name;
+        if (settings_.router_type_ == transport_catalogue::RouterType::RAPTOR || is_single_vertex) {
+            return;
+        }
+        graph::EdgeId edge_id = AddEdge({first_id, first_id + 1, ToWeight(settings_.bus_wait_time_)}, {0, 1});
+        edgeid_to_edgeinfo_[edge_id] = WaitEdgeInfo{stop->name, static_cast<double>(settings_.bus_wait_time_)};
+        pending_updates_.push_back({edge_id, std::nullopt});
+    }
+
+    void TransportRouter::AddBus(transport_catalogue::TransportCatalogue& catalogue, transport_catalogue::bus::Bus* bus) {
+        if (catalogue.FindBus(bus->name)) {
+            throw std::invalid_argument("Changing routes of existing buses is not supported");
+        }
+        catalogue.AddBus(bus->name, bus);
+        if (settings_.router_type_ == transport_catalogue::RouterType::RAPTOR) {
+            return;
+        }
+        const graph::EdgeId first_edge_id = graph_->GetEdgeCount();
+        if (settings_.graph_model_ == transport_catalogue::GraphModel::LINE_GRAPH) {
+            graph::VertexId ride_vertex = graph_->AddVertices(bus->circle ? bus->route.size() : bus->route.size() * 2);
+            ride_vertex = ProcessLine(bus->route.begin(), bus->route.end(), catalogue, bus->name, ride_vertex);
+            if (!bus->circle) {
+                ProcessLine(bus->route.rbegin(), bus->route.rend(), catalogue, bus->name, ride_vertex);
+            }
+        } else {
+            AddBusEdges(BuildBusEdges(catalogue, {bus}));
+        }
+        for (graph::EdgeId edge_id = first_edge_id; edge_id < graph_->GetEdgeCount(); ++edge_id) {
+            pending_updates_.push_back({edge_id, std::nullopt});
+        }
+    }
+
+    // Пересчитываются веса всех рёбер автобусов, проходящих через обе остановки.
+    // Рёбра одного автобуса добавлялись подряд, поэтому их порядок по номеру совпадает с порядком CollectBusDistances
+    void TransportRouter::SetDistance(transport_catalogue::TransportCatalogue& catalogue, transport_catalogue::stop::Stop* from,
+                                      transport_catalogue::stop::Stop* to, int distance) {
+        if (settings_.prune_parallel_edges_ && settings_.router_type_ != transport_catalogue::RouterType::RAPTOR) {
+            throw std::logic_error("Can't change distances in a base with pruned parallel edges");
+        }
+        catalogue.AddDistanceBetweenStops(from, to, distance);
+        if (settings_.router_type_ == transport_catalogue::RouterType::RAPTOR) {
+            return;
+        }
+        std::unordered_map<std::string_view, std::vector<graph::EdgeId>> bus_edges;
+        for (const std::string_view bus : catalogue.GetBuses(from)) {
+            if (catalogue.GetBuses(to).count(bus)) {
+                bus_edges[bus];
+            }
+        }
+        if (bus_edges.empty()) {
+            return;
+        }
+        if (settings_.graph_model_ == transport_catalogue::GraphModel::LINE_GRAPH) {
+            for (const auto& [edge_id, ride] : edgeid_to_ride_) {
+                if (auto it = bus_edges.find(ride.bus_name); it != bus_edges.end()) {
+                    it->second.push_back(edge_id);
+                }
+            }
+        } else {
+            for (const auto& [edge_id, info] : edgeid_to_edgeinfo_) {
+                if (const auto* bus_edge = std::get_if<BusEdgeInfo>(&info)) {
+                    if (auto it = bus_edges.find(bus_edge->bus_name); it != bus_edges.end()) {
+                        it->second.push_back(edge_id);
+                    }
+                }
+            }
+        }
+
+        for (auto& [name, edge_ids] : bus_edges) {
+            const transport_catalogue::bus::Bus* bus = catalogue.GetBusInfo(name);
+            std::vector<uint64_t> distances;
+            CollectBusDistances(bus->route.begin(), bus->route.end(), catalogue, distances);
+            if (!bus->circle) {
+                CollectBusDistances(bus->route.rbegin(), bus->route.rend(), catalogue, distances);
+            }
+            if (distances.size() != edge_ids.size()) {
+                throw std::logic_error("Bus edges don't match bus route");
+            }
+            std::sort(edge_ids.begin(), edge_ids.end());
+            for (size_t i = 0; i < edge_ids.size(); ++i) {
+                const Weight old_weight = graph_->GetEdge(edge_ids[i]).weight;
+                RawEdgeWeight& raw_weight = raw_edge_weights_.at(edge_ids[i]);
+                const Weight weight = GetEdgeWeight({distances[i], raw_weight.wait_count}, settings_);
+                if (weight == old_weight) {
+                    continue;
+                }
+                graph_->SetEdgeWeight(edge_ids[i], weight);
+                raw_weight.distance = distances[i];
+                if (auto ride_it = edgeid_to_ride_.find(edge_ids[i]); ride_it != edgeid_to_ride_.end()) {
+                    ride_it->second.distance = distances[i];
+                } else {
+                    std::get<BusEdgeInfo>(edgeid_to_edgeinfo_.at(edge_ids[i])).time = ToMinutes(GetBusTime(static_cast<double>(distances[i])));
+                }
+                pending_updates_.push_back({edge_ids[i], old_weight});
+            }
+        }
+    }
+
+    // Таблица Флойда-Уоршелла обновляется по изменённым рёбрам, остальные движки
+    // либо не хранят ничего, кроме ссылки на граф, либо строятся заново
+    void TransportRouter::ApplyUpdates(transport_catalogue::TransportCatalogue& catalogue) {
+        if (!graph_->IsFrozen()) {
+            graph_->Freeze();
+        }
+        switch (settings_.router_type_) {
+            case transport_catalogue::RouterType::FLOYD_WARSHALL:
+            case transport_catalogue::RouterType::FLOYD_WARSHALL_BLOCKED:
+                dynamic_cast<graph::Router<Weight>&>(*router_).Update(pending_updates_);
+                break;
+            case transport_catalogue::RouterType::DIJKSTRA:
+                break;
+            case transport_catalogue::RouterType::A_STAR:
+            case transport_catalogue::RouterType::BIDIRECTIONAL_DIJKSTRA:
+            case transport_catalogue::RouterType::CONTRACTION_HIERARCHIES:
+            case transport_catalogue::RouterType::HUB_LABELS:
+                BuildRouter();
+                break;
+            case transport_catalogue::RouterType::RAPTOR:
+                BuildRaptorRouter(catalogue);
+                break;
+        }
+        if (settings_.router_type_ != transport_catalogue::RouterType::RAPTOR) {
+            BuildGraphRouters();
+        }
+        pending_updates_.clear();
+        ResetRouteCache();
     }
 }
\ No newline at end of file
@@ -1,25 +1,101 @@
 #pragma once
 
 #include "router.h"
+#include "dijkstra_router.h"
+#include "astar_router.h"
+#include "bidirectional_dijkstra_router.h"
+#include "contraction_hierarchy.h"
+#include "hub_labels.h"
+#include "pareto_router.h"
+#include "yen_router.h"
+#include "raptor_router.h"
+#include "route_cache.h"
 #include "transport_catalogue.h"
+#include "parallel.h"
+#include "vertex_order.h"
+#include <cmath>
 #include <memory>
+#include <type_traits>
 #include "domain.h"
 
 namespace transport_router {
     using EdgeInfo = std::variant<WaitEdgeInfo, BusEdgeInfo>;
+
+    // Тип весов графа выбирается при сборке. С TRANSPORT_ROUTER_FIXED_POINT_WEIGHTS веса — целые сотые доли секунды:
+    // суммы не зависят от порядка сложения и машины, а ядро min-plus работает с целыми строками.
+    // В минуты веса переводятся только при выдаче ответа
+#ifdef TRANSPORT_ROUTER_FIXED_POINT_WEIGHTS
+    using Weight = uint32_t;
+    inline constexpr uint32_t WEIGHT_UNITS_PER_MINUTE = 6000;
+#else
+    using Weight = double;
+    inline constexpr uint32_t WEIGHT_UNITS_PER_MINUTE = 0;
+#endif
+
+    inline Weight ToWeight(double minutes) {
+        if constexpr (std::is_integral_v<Weight>) {
+            return static_cast<Weight>(std::llround(minutes * WEIGHT_UNITS_PER_MINUTE));
+        } else {
+            return minutes;
+        }
+    }
+
+    inline double ToMinutes(Weight weight) {
+        if constexpr (std::is_integral_v<Weight>) {
+            return static_cast<double>(weight) / WEIGHT_UNITS_PER_MINUTE;
+        } else {
+            return weight;
+        }
+    }
+
     class TransportRouter {
     public:
         explicit TransportRouter(transport_catalogue::RoutingSettings& settings) : settings_(settings){}
 
         void BuildTransportRouter(transport_catalogue::TransportCatalogue& catalogue);
 
-        void GetStops(const std::unordered_map<std::string_view, transport_catalogue::stop::Stop*>& stops);
+        // Остановки в порядке нумерации их вершин по настройке vertex_order_
+        std::vector<transport_catalogue::stop::Stop*> OrderStops(transport_catalogue::TransportCatalogue& catalogue) const;
+
+        void GetStops(const std::vector<transport_catalogue::stop::Stop*>& stops);
 
         void LoadWaitEdges();
 
-        void LoadBusEdges(transport_catalogue::TransportCatalogue catalogue);
+        void LoadBusEdges(transport_catalogue::TransportCatalogue& catalogue);
+
+        size_t CountRideVertices(transport_catalogue::TransportCatalogue& catalogue) const;
+
+        void LoadBusLines(transport_catalogue::TransportCatalogue& catalogue);
+
+        // Из рёбер с общими началом и концом остаётся самое лёгкое. Такие рёбра несут одинаковое
+        // число посадок, поэтому отброшенные не оптимальны и по Парето
+        void PruneParallelEdges();
+
+        // Число рёбер, отброшенных PruneParallelEdges при построении графа
+        size_t GetPrunedEdgeCount() const;
+
+        void BuildRouter();
+
+        graph::AStarRouter<Weight>::LowerBound BuildGeoLowerBound() const;
+
+        void BuildRaptorRouter(transport_catalogue::TransportCatalogue& catalogue);
+
+        // Движки особых запросов работают прямо по графу при любом router_type, кроме RAPTOR.
+        // Посадками для поиска по двум критериям считаются рёбра ожидания
+        void BuildGraphRouters();
+
+        graph::Edge<Weight> BuildBusEdge(transport_catalogue::stop::Stop* from, transport_catalogue::stop::Stop* to, const double distance) const;
+
+        Weight GetBusTime(const double distance) const;
 
-        graph::Edge<double> BuildBusEdge(transport_catalogue::stop::Stop* from, transport_catalogue::stop::Stop* to, const double distance) const;
+        Weight GetBusTime(const double distance, const transport_catalogue::RoutingSettings& settings) const;
+
+        Weight GetEdgeWeight(graph::EdgeId id, const transport_catalogue::RoutingSettings& settings) const;
+
+        Weight GetEdgeWeight(const RawEdgeWeight& raw_weight, const transport_catalogue::RoutingSettings& settings) const;
+
+        // Число ожиданий в весе ребра автобуса: в модели SINGLE_VERTEX посадка оплачивается на самом ребре
+        uint32_t GetBoardingWaitCount() const;
 
         std::optional<StopPairVertexId> GetPairVertexId(transport_catalogue::stop::Stop* stop) const;
 
@@ -27,46 +103,186 @@ namespace transport_router {
 
         std::optional<RouteInfo> GetRouteInfo(graph::VertexId from, graph::VertexId to) const;
 
+        // Маршрут по настройкам запроса: веса рёбер считаются из исходных расстояний и числа ожиданий
+        // прямо во время поиска Дейкстры, предрасчёт движка и кэш маршрутов не используются
+        std::optional<RouteInfo> GetRouteInfo(graph::VertexId from, graph::VertexId to,
+                                              const transport_catalogue::RoutingSettings& settings) const;
+
+        std::vector<std::optional<RouteInfo>> GetRouteInfos(graph::VertexId from, const std::vector<graph::VertexId>& targets) const;
+
+        // Маршруты, оптимальные по Парето по времени в пути и числу пересадок, по возрастанию времени
+        std::vector<RouteInfo> GetParetoRouteInfos(graph::VertexId from, graph::VertexId to) const;
+
+        // До count различных маршрутов без повторных остановок по возрастанию времени.
+        // RAPTOR не хранит графа и возвращает только лучший маршрут
+        std::vector<RouteInfo> GetAlternativeRouteInfos(graph::VertexId from, graph::VertexId to, size_t count) const;
+
+        // Остановки, на которые можно приехать из from не дольше чем за max_time, по возрастанию времени прибытия
+        std::vector<ReachableStop> GetReachableStops(graph::VertexId from, double max_time) const;
+
+        // Времена в пути из каждой sources в каждую targets без разбора маршрутов на элементы.
+        // Строки матрицы считаются параллельно, каждая — одним вызовом движка
+        std::vector<std::vector<std::optional<double>>> GetTravelTimeMatrix(const std::vector<graph::VertexId>& sources,
+                                                                            const std::vector<graph::VertexId>& targets) const;
+
+        // settings задаются, если маршрут найден не по базовым настройкам: времена элементов пересчитываются по ним
+        RouteInfo ConvertRouteInfo(const graph::RouteInfo<Weight>& route_info,
+                                   const transport_catalogue::RoutingSettings* settings = nullptr) const;
+
+        // Рёбра автобусов до добавления в граф, i-е ребро — edges[i], raw_weights[i] и infos[i]
+        struct BusEdges {
+            std::vector<graph::Edge<Weight>> edges;
+            std::vector<RawEdgeWeight> raw_weights;
+            std::vector<BusEdgeInfo> infos;
+        };
+
+        // Рёбра автобусов строятся параллельно, каждый автобус пишет в свой участок буфера.
+        // Участки идут в порядке buses, поэтому номера рёбер не зависят от числа потоков
+        BusEdges BuildBusEdges(transport_catalogue::TransportCatalogue& catalogue,
+                               const std::vector<transport_catalogue::bus::Bus*>& buses) const;
+
+        void AddBusEdges(BusEdges&& bus_edges);
+
+        // Пишет рёбра направления в bus_edges начиная с position, возвращает позицию следующего ребра
+        template <typename InputIt>
+        size_t ProcessRoute(InputIt range_begin, InputIt range_end, transport_catalogue::TransportCatalogue& transport_catalogue,
+                            std::string_view bus, BusEdges& bus_edges, size_t position) const;
+
         template <typename InputIt>
-        void ProcessRoute(InputIt range_begin, InputIt range_end, transport_catalogue::TransportCatalogue transport_catalogue, std::string_view bus);
+        graph::VertexId ProcessLine(InputIt range_begin, InputIt range_end, transport_catalogue::TransportCatalogue& transport_catalogue,
+                                    std::string_view bus, graph::VertexId ride_vertex);
 
         transport_catalogue::RoutingSettings& GetRoutingSettings();
 
-        const graph::DirectedWeightedGraph<double>& GetGraph() const;
+        const graph::DirectedWeightedGraph<Weight>& GetGraph() const;
 
-        const graph::Router<double>& GetRouter() const;
+        const graph::RouterEngine<Weight>& GetRouter() const;
+
+        std::optional<graph::SearchStats> GetSearchStats() const;
+
+        // Создаёт пустой кэш маршрутов по текущим настройкам; вызывается после любого изменения движка
+        void ResetRouteCache();
+
+        std::optional<RouteCache::Stats> GetRouteCacheStats() const;
 
         const std::unordered_map<transport_catalogue::stop::Stop*, StopPairVertexId>& GetStopAsPairNumber() const;
 
         const std::unordered_map<graph::EdgeId, std::variant<WaitEdgeInfo, BusEdgeInfo>> GetEdgeidToType() const;
 
-        void SetGraph(std::vector<graph::Edge<double>>&& edges, std::vector<graph::DirectedWeightedGraph<double>::IncidenceList>&& incidence_lists);
+        const std::unordered_map<graph::EdgeId, RideEdgeInfo>& GetEdgeidToRide() const;
+
+        const std::vector<RawEdgeWeight>& GetRawEdgeWeights() const;
+
+        void SetGraph(graph::DirectedWeightedGraph<Weight>&& graph);
 
         void SetStopAsPairNumber(std::unordered_map<transport_catalogue::stop::Stop*, StopPairVertexId>&& stop_as_pair_number);
 
         void SetEdgeidToType(std::unordered_map<graph::EdgeId, EdgeInfo>&& edge_id_to_type);
 
-        void SetRouter(graph::Router<double>::RoutesInternalData&& routes_internal_data);
+        void SetEdgeidToRide(std::unordered_map<graph::EdgeId, RideEdgeInfo>&& edge_id_to_ride);
+
+        void SetRawEdgeWeights(std::vector<RawEdgeWeight>&& raw_edge_weights);
+
+        void SetRouter(graph::Router<Weight>::RoutesInternalData&& routes_internal_data);
+
+        void SetRouter(std::vector<size_t>&& ranks, std::vector<graph::ContractionHierarchy<Weight>::Shortcut>&& shortcuts);
+
+        void SetRouter(graph::HubLabels<Weight>::Labels&& forward_labels, graph::HubLabels<Weight>::Labels&& backward_labels);
+
+        // Инкрементальные изменения сети: справочник и граф меняются сразу,
+        // движок маршрутизации доводится до нового графа вызовом ApplyUpdates
+        void AddStop(transport_catalogue::TransportCatalogue& catalogue, transport_catalogue::stop::Stop* stop);
+
+        void AddBus(transport_catalogue::TransportCatalogue& catalogue, transport_catalogue::bus::Bus* bus);
+
+        void SetDistance(transport_catalogue::TransportCatalogue& catalogue, transport_catalogue::stop::Stop* from,
+                         transport_catalogue::stop::Stop* to, int distance);
+
+        void ApplyUpdates(transport_catalogue::TransportCatalogue& catalogue);
+
+        template <typename InputIt>
+        void CollectBusDistances(InputIt range_begin, InputIt range_end, transport_catalogue::TransportCatalogue& transport_catalogue,
+                                 std::vector<uint64_t>& distances) const;
 
     private:
+            graph::EdgeId AddEdge(const graph::Edge<Weight>& edge, RawEdgeWeight raw_weight);
+
+            void IndexStopVertices();
+
             transport_catalogue::RoutingSettings& settings_;
-            std::unique_ptr<graph::DirectedWeightedGraph<double>> graph_;
-            std::unique_ptr<graph::Router<double>> router_;
+            std::unique_ptr<graph::DirectedWeightedGraph<Weight>> graph_;
+            std::unique_ptr<graph::RouterEngine<Weight>> router_;
+            std::unique_ptr<RaptorRouter> raptor_router_;
+            std::unique_ptr<graph::ParetoRouter<Weight>> pareto_router_;
+            std::unique_ptr<graph::YenRouter<Weight>> yen_router_;
             std::unordered_map<transport_catalogue::stop::Stop*, StopPairVertexId> stop_as_pair_number_;
+            // Название остановки по её вершине bus_wait_begin, для элементов Wait модели SINGLE_VERTEX
+            std::vector<std::string_view> vertex_stop_names_;
             std::unordered_map<graph::EdgeId, EdgeInfo> edgeid_to_edgeinfo_;
+            std::unordered_map<graph::EdgeId, RideEdgeInfo> edgeid_to_ride_;
+            // Исходные величины весов по номеру ребра
+            std::vector<RawEdgeWeight> raw_edge_weights_;
+            std::vector<graph::EdgeUpdate<Weight>> pending_updates_;
+            std::unique_ptr<RouteCache> route_cache_;
+            size_t pruned_edge_count_ = 0;
         };
 
         template <typename InputIt>
-        void TransportRouter::ProcessRoute(InputIt range_begin, InputIt range_end, transport_catalogue::TransportCatalogue transport_catalogue, std::string_view bus) {
+        size_t TransportRouter::ProcessRoute(InputIt range_begin, InputIt range_end, transport_catalogue::TransportCatalogue& transport_catalogue,
+                                             std::string_view bus, BusEdges& bus_edges, size_t position) const {
             for (auto stop_from = range_begin; stop_from != range_end; ++stop_from) {
                 size_t distance = 0;
                 size_t span_count = 0;
-                for (auto stop_to = next(stop_from); stop_to != range_end; ++stop_to) {
+                for (auto stop_to = next(stop_from); stop_to != range_end; ++stop_to, ++position) {
                     auto before_stop_to = prev(stop_to);
                     distance += transport_catalogue.GetDistanceBetween(*before_stop_to, *stop_to);
                     ++span_count;
-                    graph::EdgeId edge_id = graph_->AddEdge({BuildBusEdge(*stop_from, *stop_to, distance)});
-                    edgeid_to_edgeinfo_[edge_id] = BusEdgeInfo{bus, span_count, graph_->GetEdge(edge_id).weight};
+                    bus_edges.edges[position] = BuildBusEdge(*stop_from, *stop_to, distance);
+                    bus_edges.raw_weights[position] = {distance, GetBoardingWaitCount()};
+                    bus_edges.infos[position] = BusEdgeInfo{bus, span_count, ToMinutes(GetBusTime(static_cast<double>(distance)))};
+                }
+            }
+            return position;
+        }
+
+        // Вершины ride_vertex, ride_vertex + 1, ... соответствуют остановкам направления по порядку:
+        // посадка ведёт из bus_wait_end остановки в её вершину-перегон, высадка — обратно в bus_wait_begin
+        template <typename InputIt>
+        graph::VertexId TransportRouter::ProcessLine(InputIt range_begin, InputIt range_end, transport_catalogue::TransportCatalogue& transport_catalogue,
+                                                     std::string_view bus, graph::VertexId ride_vertex) {
+            for (auto stop = range_begin; stop != range_end; ++stop, ++ride_vertex) {
+                const StopPairVertexId& stop_vertex = stop_as_pair_number_.at(*stop);
+                if (stop != range_begin) {
+                    const uint64_t distance = transport_catalogue.GetDistanceBetween(*prev(stop), *stop);
+                    graph::EdgeId edge_id = AddEdge({ride_vertex - 1, ride_vertex, GetBusTime(static_cast<double>(distance))}, {distance, 0});
+                    edgeid_to_ride_[edge_id] = RideEdgeInfo{bus, distance};
+                    AddEdge({ride_vertex, stop_vertex.bus_wait_begin, 0}, {});
+                }
+                if (next(stop) != range_end) {
+                    AddEdge({stop_vertex.bus_wait_end, ride_vertex, 0}, {});
+                }
+            }
+            return ride_vertex;
+        }
+
+        // Расстояния рёбер автобуса в порядке их добавления: накопленные для каждой пары остановок
+        // в модели STOP_PAIRS и расстояния перегонов в модели LINE_GRAPH
+        template <typename InputIt>
+        void TransportRouter::CollectBusDistances(InputIt range_begin, InputIt range_end, transport_catalogue::TransportCatalogue& transport_catalogue,
+                                                  std::vector<uint64_t>& distances) const {
+            if (settings_.graph_model_ == transport_catalogue::GraphModel::LINE_GRAPH) {
+                for (auto stop = range_begin; stop != range_end; ++stop) {
+                    if (stop != range_begin) {
+                        distances.push_back(transport_catalogue.GetDistanceBetween(*prev(stop), *stop));
+                    }
+                }
+                return;
+            }
+            for (auto stop_from = range_begin; stop_from != range_end; ++stop_from) {
+                uint64_t distance = 0;
+                for (auto stop_to = next(stop_from); stop_to != range_end; ++stop_to) {
+                    distance += transport_catalogue.GetDistanceBetween(*prev(stop_to), *stop_to);
+                    distances.push_back(distance);
                 }
             }
         }
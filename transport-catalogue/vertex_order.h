@@ -0,0 +1,108 @@
+#pragma once
+
+#include "geo.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <queue>
+#include <utility>
+#include <vector>
+
+// Порядки нумерации вершин, при которых близкие вершины получают близкие номера:
+// строки таблицы маршрутов и рёбра в CSR соседних вершин оказываются рядом в памяти.
+// Каждая функция возвращает order: order[i] — исходный номер элемента, который получает номер i
+namespace vertex_order {
+
+    // Номер точки (x, y) решётки 65536 x 65536 на кривой Гильберта
+    inline uint64_t GetHilbertIndex(uint32_t x, uint32_t y) {
+        constexpr uint32_t SIDE = 1u << 16;
+        uint64_t index = 0;
+        for (uint32_t half = SIDE / 2; half > 0; half /= 2) {
+            const uint32_t rx = (x & half) > 0 ? 1 : 0;
+            const uint32_t ry = (y & half) > 0 ? 1 : 0;
+            index += static_cast<uint64_t>(half) * half * ((3 * rx) ^ ry);
+            // Поворот четверти, чтобы кривая внутри неё шла в нужном направлении
+            if (ry == 0) {
+                if (rx == 1) {
+                    x = SIDE - 1 - x;
+                    y = SIDE - 1 - y;
+                }
+                std::swap(x, y);
+            }
+        }
+        return index;
+    }
+
+    // Точки упорядочиваются вдоль кривой Гильберта в охватывающем их прямоугольнике
+    inline std::vector<size_t> GetHilbertOrder(const std::vector<Coordinates>& points) {
+        std::vector<size_t> order(points.size());
+        std::iota(order.begin(), order.end(), 0);
+        if (points.empty()) {
+            return order;
+        }
+        const auto [min_lat, max_lat] = std::minmax_element(points.begin(), points.end(), [](const Coordinates& lhs, const Coordinates& rhs) {
+            return lhs.lat < rhs.lat;
+        });
+        const auto [min_lng, max_lng] = std::minmax_element(points.begin(), points.end(), [](const Coordinates& lhs, const Coordinates& rhs) {
+            return lhs.lng < rhs.lng;
+        });
+        auto scale = [](double value, double min_value, double max_value) {
+            return max_value > min_value ? static_cast<uint32_t>((value - min_value) / (max_value - min_value) * 65535.0) : 0u;
+        };
+        std::vector<uint64_t> indices(points.size());
+        for (size_t i = 0; i < points.size(); ++i) {
+            indices[i] = GetHilbertIndex(scale(points[i].lng, min_lng->lng, max_lng->lng),
+                                         scale(points[i].lat, min_lat->lat, max_lat->lat));
+        }
+        std::stable_sort(order.begin(), order.end(), [&indices](size_t lhs, size_t rhs) {
+            return indices[lhs] < indices[rhs];
+        });
+        return order;
+    }
+
+    // Обратный порядок Катхилла — Макки: обход в ширину каждой компоненты связности от вершины
+    // наименьшей степени, соседи посещаются по возрастанию степени, полученный порядок переворачивается.
+    // Список смежности должен быть симметричным и без повторов
+    inline std::vector<size_t> GetReverseCuthillMcKeeOrder(const std::vector<std::vector<size_t>>& adjacency) {
+        const size_t count = adjacency.size();
+        auto is_less_degree = [&adjacency](size_t lhs, size_t rhs) {
+            return std::pair{adjacency[lhs].size(), lhs} < std::pair{adjacency[rhs].size(), rhs};
+        };
+        std::vector<size_t> starts(count);
+        std::iota(starts.begin(), starts.end(), 0);
+        std::sort(starts.begin(), starts.end(), is_less_degree);
+
+        std::vector<size_t> order;
+        order.reserve(count);
+        std::vector<bool> is_visited(count, false);
+        std::vector<size_t> neighbors;
+        for (const size_t start : starts) {
+            if (is_visited[start]) {
+                continue;
+            }
+            is_visited[start] = true;
+            std::queue<size_t> queue;
+            queue.push(start);
+            while (!queue.empty()) {
+                const size_t item = queue.front();
+                queue.pop();
+                order.push_back(item);
+                neighbors.clear();
+                for (const size_t neighbor : adjacency[item]) {
+                    if (!is_visited[neighbor]) {
+                        is_visited[neighbor] = true;
+                        neighbors.push_back(neighbor);
+                    }
+                }
+                std::sort(neighbors.begin(), neighbors.end(), is_less_degree);
+                for (const size_t neighbor : neighbors) {
+                    queue.push(neighbor);
+                }
+            }
+        }
+        std::reverse(order.begin(), order.end());
+        return order;
+    }
+
+}
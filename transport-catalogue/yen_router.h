@@ -0,0 +1,259 @@
+#pragma once
+
+#include "graph.h"
+#include "router_engine.h"
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <set>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+    // k кратчайших простых путей по алгоритму Йена. Обратное дерево кратчайших путей до цели строится
+    // один раз на запрос и переиспользуется всеми поисками ответвлений: если путь по дереву от вершины
+    // ответвления не задевает запрещённых вершин и рёбер, он и есть ответвление. Иначе ответвление ищется
+    // A* с расстояниями дерева в качестве точной нижней оценки — запреты только удлиняют пути
+    template <typename Weight>
+    class YenRouter {
+    private:
+        using Graph = DirectedWeightedGraph<Weight>;
+
+    public:
+        explicit YenRouter(const Graph& graph);
+
+        // Не более count путей по возрастанию веса
+        std::vector<RouteInfo<Weight>> BuildRoutes(VertexId from, VertexId to, size_t count) const;
+
+    private:
+        using QueueItem = std::pair<Weight, VertexId>;
+        using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+        // Расстояния до цели и первые рёбра путей до неё по обратному дереву
+        struct ReverseTree {
+            std::vector<std::optional<Weight>> weights;
+            std::vector<std::optional<EdgeId>> next_edges;
+        };
+
+        // Состояние поиска ответвлений, общее для всех поисков одного запроса
+        struct SpurSearch {
+            explicit SpurSearch(size_t vertex_count)
+                    : weights(vertex_count), prev_edges(vertex_count), is_blocked_vertex(vertex_count, false) {
+            }
+
+            std::vector<std::optional<Weight>> weights;
+            std::vector<std::optional<EdgeId>> prev_edges;
+            std::vector<VertexId> touched_vertices;
+            std::vector<bool> is_blocked_vertex;
+            std::vector<EdgeId> blocked_edges;
+        };
+
+        ReverseTree BuildReverseTree(VertexId to) const;
+
+        std::optional<std::vector<EdgeId>> FindSpurPath(VertexId spur, VertexId to, const ReverseTree& tree,
+                                                        SpurSearch& search) const;
+
+        Weight SumWeights(const std::vector<EdgeId>& edges) const;
+
+        static constexpr Weight ZERO_WEIGHT{};
+        const Graph& graph_;
+        std::vector<size_t> incoming_offsets_;
+        // Поле to входящего ребра хранит его начало
+        typename Graph::IncidenceList incoming_edges_;
+    };
+
+    template <typename Weight>
+    YenRouter<Weight>::YenRouter(const Graph& graph)
+            : graph_(graph)
+            , incoming_offsets_(graph.GetVertexCount() + 1, 0) {
+        const auto& edges = graph_.GetEdges();
+        for (const auto& edge : edges) {
+            if (edge.weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+            ++incoming_offsets_[edge.to + 1];
+        }
+        for (VertexId vertex = 0; vertex < graph_.GetVertexCount(); ++vertex) {
+            incoming_offsets_[vertex + 1] += incoming_offsets_[vertex];
+        }
+        std::vector<size_t> positions(incoming_offsets_.begin(), incoming_offsets_.end() - 1);
+        incoming_edges_.resize(edges.size());
+        for (EdgeId id = 0; id < edges.size(); ++id) {
+            const auto& edge = edges[id];
+            incoming_edges_[positions[edge.to]++] = {id, edge.from, edge.weight};
+        }
+    }
+
+    template <typename Weight>
+    typename YenRouter<Weight>::ReverseTree YenRouter<Weight>::BuildReverseTree(VertexId to) const {
+        const size_t vertex_count = graph_.GetVertexCount();
+        ReverseTree tree{std::vector<std::optional<Weight>>(vertex_count), std::vector<std::optional<EdgeId>>(vertex_count)};
+        Queue queue;
+        tree.weights[to] = ZERO_WEIGHT;
+        queue.push({ZERO_WEIGHT, to});
+        while (!queue.empty()) {
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+            if (weight > *tree.weights[vertex]) {
+                continue;
+            }
+            for (size_t i = incoming_offsets_[vertex]; i < incoming_offsets_[vertex + 1]; ++i) {
+                const auto& edge = incoming_edges_[i];
+                const Weight candidate_weight = weight + edge.weight;
+                if (!tree.weights[edge.to] || candidate_weight < *tree.weights[edge.to]) {
+                    tree.weights[edge.to] = candidate_weight;
+                    tree.next_edges[edge.to] = edge.id;
+                    queue.push({candidate_weight, edge.to});
+                }
+            }
+        }
+        return tree;
+    }
+
+    template <typename Weight>
+    std::optional<std::vector<EdgeId>> YenRouter<Weight>::FindSpurPath(VertexId spur, VertexId to, const ReverseTree& tree,
+                                                                       SpurSearch& search) const {
+        auto is_blocked_edge = [&search](EdgeId edge_id) {
+            return std::find(search.blocked_edges.begin(), search.blocked_edges.end(), edge_id) != search.blocked_edges.end();
+        };
+
+        if (!tree.weights[spur]) {
+            return std::nullopt;
+        }
+        std::vector<EdgeId> edges;
+        for (VertexId vertex = spur; vertex != to; vertex = graph_.GetEdge(edges.back()).to) {
+            const EdgeId edge_id = *tree.next_edges[vertex];
+            const VertexId next_vertex = graph_.GetEdge(edge_id).to;
+            if ((vertex == spur && is_blocked_edge(edge_id)) || search.is_blocked_vertex[next_vertex]) {
+                edges.clear();
+                break;
+            }
+            edges.push_back(edge_id);
+        }
+        if (!edges.empty() || spur == to) {
+            return edges;
+        }
+
+        // Запрещённые рёбра выходят только из вершины ответвления
+        Queue queue;
+        search.weights[spur] = ZERO_WEIGHT;
+        search.touched_vertices.push_back(spur);
+        queue.push({*tree.weights[spur], spur});
+        bool is_found = false;
+        while (!queue.empty()) {
+            const auto [estimate, vertex] = queue.top();
+            queue.pop();
+            const Weight weight = *search.weights[vertex];
+            if (estimate > weight + *tree.weights[vertex]) {
+                continue;
+            }
+            if (vertex == to) {
+                is_found = true;
+                break;
+            }
+            for (const auto& edge : graph_.GetIncidentEdges(vertex)) {
+                if (!tree.weights[edge.to] || search.is_blocked_vertex[edge.to] || (vertex == spur && is_blocked_edge(edge.id))) {
+                    continue;
+                }
+                const Weight candidate_weight = weight + edge.weight;
+                auto& edge_weight = search.weights[edge.to];
+                if (!edge_weight || candidate_weight < *edge_weight) {
+                    if (!edge_weight) {
+                        search.touched_vertices.push_back(edge.to);
+                    }
+                    edge_weight = candidate_weight;
+                    search.prev_edges[edge.to] = edge.id;
+                    queue.push({candidate_weight + *tree.weights[edge.to], edge.to});
+                }
+            }
+        }
+
+        if (is_found) {
+            for (VertexId vertex = to; vertex != spur; vertex = graph_.GetEdge(edges.back()).from) {
+                edges.push_back(*search.prev_edges[vertex]);
+            }
+            std::reverse(edges.begin(), edges.end());
+        }
+        for (const VertexId vertex : search.touched_vertices) {
+            search.weights[vertex].reset();
+            search.prev_edges[vertex].reset();
+        }
+        search.touched_vertices.clear();
+        if (!is_found) {
+            return std::nullopt;
+        }
+        return edges;
+    }
+
+    template <typename Weight>
+    Weight YenRouter<Weight>::SumWeights(const std::vector<EdgeId>& edges) const {
+        Weight weight = ZERO_WEIGHT;
+        for (const EdgeId edge_id : edges) {
+            weight += graph_.GetEdge(edge_id).weight;
+        }
+        return weight;
+    }
+
+    template <typename Weight>
+    std::vector<RouteInfo<Weight>> YenRouter<Weight>::BuildRoutes(VertexId from, VertexId to, size_t count) const {
+        const size_t vertex_count = graph_.GetVertexCount();
+        if (from >= vertex_count || to >= vertex_count) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+        if (count == 0) {
+            return {};
+        }
+        if (from == to) {
+            return {RouteInfo<Weight>{ZERO_WEIGHT, {}}};
+        }
+
+        const ReverseTree tree = BuildReverseTree(to);
+        SpurSearch search(vertex_count);
+        std::vector<RouteInfo<Weight>> routes;
+        if (auto edges = FindSpurPath(from, to, tree, search)) {
+            routes.push_back({SumWeights(*edges), std::move(*edges)});
+        }
+        // Кандидаты упорядочены по весу, одинаковые пути хранятся один раз
+        std::set<std::pair<Weight, std::vector<EdgeId>>> candidates;
+
+        while (!routes.empty() && routes.size() < count) {
+            const std::vector<EdgeId> last_edges = routes.back().edges;
+            VertexId spur = from;
+            for (size_t i = 0; i < last_edges.size(); ++i) {
+                // Следующие рёбра уже найденных путей с тем же началом запрещаются
+                for (const auto& route : routes) {
+                    if (route.edges.size() > i && std::equal(last_edges.begin(), last_edges.begin() + i, route.edges.begin())) {
+                        search.blocked_edges.push_back(route.edges[i]);
+                    }
+                }
+                if (auto spur_edges = FindSpurPath(spur, to, tree, search)) {
+                    std::vector<EdgeId> edges(last_edges.begin(), last_edges.begin() + i);
+                    edges.insert(edges.end(), spur_edges->begin(), spur_edges->end());
+                    const Weight weight = SumWeights(edges);
+                    candidates.emplace(weight, std::move(edges));
+                }
+                search.blocked_edges.clear();
+                // Путь без петель не возвращается в вершины своего начала
+                search.is_blocked_vertex[spur] = true;
+                spur = graph_.GetEdge(last_edges[i]).to;
+            }
+            VertexId vertex = from;
+            for (const EdgeId edge_id : last_edges) {
+                search.is_blocked_vertex[vertex] = false;
+                vertex = graph_.GetEdge(edge_id).to;
+            }
+
+            if (candidates.empty()) {
+                break;
+            }
+            auto node = candidates.extract(candidates.begin());
+            routes.push_back({node.value().first, std::move(node.value().second)});
+        }
+        return routes;
+    }
+
+}